@@ -0,0 +1,117 @@
+/****************************************************************************
+* Conversions.h
+*
+* @hardware    : UHF Transceiver
+* @manual      : USM-01-00097 User Manual Rev. C
+* @about       : conversions of the raw transceiver sensor readings into
+*                engineering units. The ADC channels are evaluated once per
+*                code at compile time into lookup tables, so a conversion is
+*                a single load, and whole arrays of readings (e.g. a
+*                telemetry history) convert in a tight loop.
+* @author      : Carlos Carrasquillo
+* @contact     : c.carrasquillo@ufl.edu
+* @date        : October 17, 2026
+* @modified    : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef CONVERSIONS
+#define CONVERSIONS
+
+
+/************************** Includes **************************/
+#include <stdint.h>
+
+
+/*************************** Defines ***************************/
+#define ADC_VREF                3.0                         // full scale of the sensor ADCs [V]
+#define ADC_12BIT_CODES         4096
+#define ADC_13BIT_CODES         8192
+#define RSSI_MASK               0x0FFF                      // 12-bit reading (see pp. 26)
+#define BUS_VOLTAGE_MASK        0x1FFF                      // 13-bit reading (see pp. 27)
+#define PA_POWER_MASK           0x0FFF                      // 12-bit reading (see pp. 28)
+#define CURRENT_3V3_SCALE       0.000003                    // [A] per LSB (see pp. 27)
+#define CURRENT_5V_SCALE        0.000062                    // [A] per LSB (see pp. 27)
+#define BUS_VOLTAGE_SCALE       0.004                       // [V] per LSB (see pp. 27)
+#define PA_COUPLING_DB          32.5                        // actual = coupled + 32.5 dB (see pp. 28)
+
+
+/* the sensor channels of the transceiver */
+enum conv_channel_t {
+	CONV_RAW,                                               // no conversion (status and configuration registers)
+	CONV_RSSI,                                              // V
+	CONV_CURRENT_3V3,                                       // A
+	CONV_CURRENT_5V,                                        // A
+	CONV_BUS_VOLTAGE,                                       // V (both the 3.3 V and 5 V supplies)
+	CONV_PA_POWER,                                          // coupled PA power, dB (forward and reverse)
+};
+
+
+/*********************** Lookup Tables ***********************/
+
+/* a table of N entries filled at compile time from f(code) */
+template <int N>
+struct conv_table_t {
+	float value[N];
+
+	template <class F>
+	constexpr conv_table_t(F f) : value() {
+		for (int code = 0; code < N; code++) value[code] = (float)f(code);
+	}
+};
+
+/* the sixth-order fit of the coupled power detector, evaluated in Horner form (see pp. 28) */
+constexpr double conv_pa_power_poly(int code) {
+	double x = code * (ADC_VREF / ADC_12BIT_CODES);
+	return ((((((-68838*x + 228000)*x - 308831)*x + 218934)*x - 85741)*x + 17660)*x) - 1511.8;
+}
+
+inline constexpr conv_table_t<ADC_12BIT_CODES> conv_rssi_lut(
+	[](int code) { return code * (ADC_VREF / ADC_12BIT_CODES); });
+inline constexpr conv_table_t<ADC_13BIT_CODES> conv_bus_voltage_lut(
+	[](int code) { return code * BUS_VOLTAGE_SCALE; });
+inline constexpr conv_table_t<ADC_12BIT_CODES> conv_pa_power_lut(conv_pa_power_poly);
+
+static_assert(conv_rssi_lut.value[ADC_12BIT_CODES / 2] == 1.5f, "RSSI table is off scale");
+static_assert(conv_pa_power_lut.value[0] == -1511.8f, "PA power table is off scale");
+
+
+/************************* Conversions ************************/
+
+/* converts one raw reading */
+inline float conv(conv_channel_t channel, uint16_t code) {
+	switch (channel) {
+		case CONV_RAW:          return code;
+		case CONV_RSSI:         return conv_rssi_lut.value[code & RSSI_MASK];
+		case CONV_CURRENT_3V3:  return code * (float)CURRENT_3V3_SCALE;     // full 16-bit reading: scaled, not tabled
+		case CONV_CURRENT_5V:   return code * (float)CURRENT_5V_SCALE;
+		case CONV_BUS_VOLTAGE:  return conv_bus_voltage_lut.value[code & BUS_VOLTAGE_MASK];
+		case CONV_PA_POWER:     return conv_pa_power_lut.value[code & PA_POWER_MASK];
+	}
+	return 0;
+}
+
+/* converts 'n' raw readings of one channel; the channel is resolved once, outside the loop */
+inline void conv(conv_channel_t channel, const uint16_t* codes, float* out, int n) {
+	const float* lut = nullptr;
+	uint16_t mask = 0;
+	float scale = 0;
+
+	switch (channel) {
+		case CONV_RSSI:         lut = conv_rssi_lut.value; mask = RSSI_MASK; break;
+		case CONV_BUS_VOLTAGE:  lut = conv_bus_voltage_lut.value; mask = BUS_VOLTAGE_MASK; break;
+		case CONV_PA_POWER:     lut = conv_pa_power_lut.value; mask = PA_POWER_MASK; break;
+		case CONV_CURRENT_3V3:  scale = (float)CURRENT_3V3_SCALE; break;
+		case CONV_CURRENT_5V:   scale = (float)CURRENT_5V_SCALE; break;
+		case CONV_RAW:          scale = 1; break;
+	}
+
+	if (lut) {
+		for (int i = 0; i < n; i++) out[i] = lut[codes[i] & mask];
+	} else {
+		for (int i = 0; i < n; i++) out[i] = codes[i] * scale;
+	}
+}
+
+#endif // CONVERSIONS
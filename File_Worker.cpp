@@ -0,0 +1,79 @@
+ /****************************************************************************
+ * File_Worker.cpp
+ *
+ * @about      : keeps file I/O (command history, uploads, downlinked files)
+ *               off the radio's service thread. Each job is an I/O step that
+ *               runs on the file thread and a completion that runs back on
+ *               the service thread, in order. Until start() is called the
+ *               jobs run inline, exactly as if there were no worker.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include "File_Worker.h"
+
+File_Worker::File_Worker() {
+	outstanding = 0;
+}
+
+File_Worker::~File_Worker() {
+	stop();
+}
+
+void File_Worker::start() {
+	if (!thread) thread.reset(new I2C_Worker());
+}
+
+void File_Worker::stop() {
+	thread.reset();													// the worker drains its queue before it exits
+
+	std::lock_guard<std::mutex> lock(done_lock);
+	outstanding -= done.size();
+	done.clear();
+}
+
+bool File_Worker::threaded() const {
+	return (bool)thread;
+}
+
+void File_Worker::submit(std::function<int()> io, std::function<void(int)> complete) {
+	if (!thread) {
+		int result = io();
+		if (complete) complete(result);
+		return;
+	}
+
+	outstanding++;
+	thread->post([this, io, complete]() {
+		int result = io();
+		std::lock_guard<std::mutex> lock(done_lock);
+		done.emplace_back(complete, result);
+	});
+}
+
+int File_Worker::service() {
+	int serviced = 0;
+
+	while (true) {
+		std::pair<std::function<void(int)>, int> next;
+		{
+			/* the file thread only holds the lock to append, so a miss is simply picked up on the next pass */
+			std::unique_lock<std::mutex> lock(done_lock, std::try_to_lock);
+			if (!lock.owns_lock() || done.empty()) break;
+			next = std::move(done.front());
+			done.pop_front();
+		}
+		if (next.first) next.first(next.second);
+		outstanding--;
+		serviced++;
+	}
+	return serviced;
+}
+
+uint32_t File_Worker::pending() const {
+	return outstanding;
+}
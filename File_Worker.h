@@ -0,0 +1,55 @@
+/****************************************************************************
+* File_Worker.h
+*
+* @about      : keeps file I/O (command history, uploads, downlinked files)
+*               off the radio's service thread. Each job is an I/O step that
+*               runs on the file thread and a completion that runs back on
+*               the service thread, in order. Until start() is called the
+*               jobs run inline, exactly as if there were no worker.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef FILE_WORKER_H
+#define FILE_WORKER_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include "I2C_Worker.h"
+
+
+/*************************** Worker ***************************/
+
+class File_Worker {
+private:
+	std::unique_ptr<I2C_Worker> thread;								// the file thread (I2C_Worker's queue is not bus-specific), 0 while inline
+	std::mutex done_lock;											// only ever try_lock()ed by the service thread
+	std::deque<std::pair<std::function<void(int)>, int>> done;		// completions waiting for the service thread
+	std::atomic<uint32_t> outstanding;								// jobs whose completion has not run yet
+
+public:
+	File_Worker();
+	~File_Worker();
+
+	void start();													// moves the I/O onto its own thread
+	void stop();													// finishes the queued I/O and returns to inline (unserviced completions are dropped)
+	bool threaded() const;
+
+	void submit(std::function<int()> io, std::function<void(int)> complete = nullptr);	// queues io(); complete(result) later runs in service()
+	int service();													// runs the finished completions on the calling thread without blocking, returns how many
+	uint32_t pending() const;										// jobs not yet completed
+};
+
+#endif // FILE_WORKER_H
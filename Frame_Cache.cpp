@@ -0,0 +1,158 @@
+/****************************************************************************
+* Frame_Cache.cpp
+*
+* @about      : keeps the packets of recently downlinked files, so a file
+*               that is requested again (health, history) goes out without
+*               being read, compressed or packed a second time. Entries are
+*               keyed by path, modification time and size, and the least
+*               recently used ones are evicted to stay under a memory cap.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+#include <sys/stat.h>
+#include "Frame_Cache.h"
+
+
+int frame_key_t::load(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) < 0 || !S_ISREG(info.st_mode)) return -1;
+
+    this->path = path;
+    mtime_ns = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+    size = info.st_size;
+    return 0;
+}
+
+bool frame_key_t::operator==(const frame_key_t& other) const {
+    return mtime_ns == other.mtime_ns && size == other.size && path == other.path;
+}
+
+size_t cached_frames_t::footprint() const {
+    return bytes.size() + lens.size() * sizeof(uint16_t) + key.path.size();
+}
+
+Frame_Cache::Frame_Cache(size_t limit) {
+    this->limit = limit;
+    used = 0;
+    recording_active = false;
+    recording_id = 0;
+    stats = {};
+}
+
+void Frame_Cache::evict(std::list<cached_frames_t>::iterator entry) {
+    used -= entry->footprint();
+    index.erase(entry->key.path);
+    entries.erase(entry);
+}
+
+void Frame_Cache::setLimit(size_t bytes) {
+    limit = bytes;
+    while (used > limit) {
+        evict(std::prev(entries.end()));
+        stats.evictions++;
+    }
+}
+
+void Frame_Cache::clear() {
+    entries.clear();
+    index.clear();
+    used = 0;
+    abort();
+}
+
+const cached_frames_t* Frame_Cache::find(const frame_key_t& key) {
+    auto found = index.find(key.path);
+    if (found == index.end() || !(found->second->key == key)) {
+        /* an older version of the file will not be asked for again */
+        if (found != index.end()) evict(found->second);
+        stats.misses++;
+        return nullptr;
+    }
+
+    entries.splice(entries.begin(), entries, found->second);
+    stats.hits++;
+    return &entries.front();
+}
+
+uint32_t Frame_Cache::record(const frame_key_t& key, size_t expected) {
+    recording.key = key;
+    recording.bytes.clear();
+    recording.lens.clear();
+    recording.bytes.reserve(std::min(expected, limit));    // the packets are appended on the service thread, so they are not allocated one by one
+    recording_active = true;
+    if (++recording_id == 0) recording_id = 1;
+    return recording_id;
+}
+
+void Frame_Cache::append(uint32_t id, const uint8_t* packet, int n) {
+    /* replies sent while the file goes out (acknowledgements, errors) are not part of it */
+    if (!recording_active || id != recording_id) return;
+
+    /* a downlink bigger than the cache could never be kept, so it is not held while it goes out */
+    if (recording.footprint() + n + sizeof(uint16_t) > limit) {
+        stats.uncacheable++;
+        abort();
+        return;
+    }
+    recording.bytes.insert(recording.bytes.end(), packet, packet + n);
+    recording.lens.push_back(n);
+}
+
+void Frame_Cache::commit() {
+    if (!recording_active) return;
+    recording_active = false;
+    if (recording.footprint() > limit) {        // the cap shrank while it went out
+        stats.uncacheable++;
+        abort();
+        return;
+    }
+
+    auto stale = index.find(recording.key.path);
+    if (stale != index.end()) evict(stale->second);
+
+    size_t footprint = recording.footprint();
+    while (used + footprint > limit) {
+        evict(std::prev(entries.end()));
+        stats.evictions++;
+    }
+
+    entries.emplace_front(std::move(recording));
+    entries.front().bytes.shrink_to_fit();
+    index[entries.front().key.path] = entries.begin();
+    used += entries.front().footprint();
+    recording = cached_frames_t();
+}
+
+void Frame_Cache::abort() {
+    recording_active = false;
+    recording = cached_frames_t();
+}
+
+void Frame_Cache::noteFirstPacket(bool hit, uint64_t wait_ns) {
+    if (hit) {
+        stats.hit_waits++;
+        stats.hit_wait_ns += wait_ns;
+    } else {
+        stats.miss_waits++;
+        stats.miss_wait_ns += wait_ns;
+    }
+}
+
+const frame_cache_stats_t& Frame_Cache::getStats() const {
+    return stats;
+}
+
+void Frame_Cache::printStats() {
+    std::cout << std::dec << "Frame Cache (" << used << " of " << limit << " bytes, " << entries.size() << " entries):" << std::endl;
+    std::cout << "\tHits: " << stats.hits << ", Misses: " << stats.misses << ", Evictions: " << stats.evictions
+              << ", Uncacheable: " << stats.uncacheable << std::endl;
+    std::cout << "\tFirst Packet: Hit Avg: " << (stats.hit_waits ? stats.hit_wait_ns / stats.hit_waits / 1e3 : 0) << " us, Miss Avg: "
+              << (stats.miss_waits ? stats.miss_wait_ns / stats.miss_waits / 1e3 : 0) << " us" << std::endl;
+}
@@ -0,0 +1,99 @@
+/****************************************************************************
+* Frame_Cache.h
+*
+* @about      : keeps the packets of recently downlinked files, so a file
+*               that is requested again (health, history) goes out without
+*               being read, compressed or packed a second time. Entries are
+*               keyed by path, modification time and size, and the least
+*               recently used ones are evicted to stay under a memory cap.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/************************** Defines ***************************/
+
+#define FRAME_CACHE_DEFAULT_BYTES   (256 * 1024)    // packet bytes kept across all entries
+
+
+/* a file as it was when its packets were built; any change to it makes a new key */
+struct frame_key_t {
+    std::string path;
+    int64_t mtime_ns = -1;
+    size_t size = 0;
+
+    int load(const std::string& path);          // the file's key as it is now (-1 if it is not a readable regular file)
+    bool operator==(const frame_key_t& other) const;
+};
+
+/* the packets of one downlink, back to back, as they were handed to the link layer */
+struct cached_frames_t {
+    frame_key_t key;
+    std::vector<uint8_t> bytes;
+    std::vector<uint16_t> lens;                 // length of each packet in 'bytes'
+
+    size_t footprint() const;
+};
+
+struct frame_cache_stats_t {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t uncacheable;                       // downlinks larger than the whole cache
+    uint64_t hit_waits;                         // downlinks served from the cache
+    uint64_t hit_wait_ns;                       // their time from request to first packet
+    uint64_t miss_waits;                        // downlinks built from the file
+    uint64_t miss_wait_ns;
+};
+
+
+/************************** Cache *****************************/
+
+class Frame_Cache {
+private:
+    std::list<cached_frames_t> entries;         // most recently used first
+    std::unordered_map<std::string, std::list<cached_frames_t>::iterator> index;   // by path
+    size_t limit;
+    size_t used;                                // footprint of every entry
+    cached_frames_t recording;                  // the downlink going out now
+    bool recording_active;
+    uint32_t recording_id;                      // the stream it belongs to (see record())
+    frame_cache_stats_t stats;
+
+    void evict(std::list<cached_frames_t>::iterator entry);
+
+public:
+    explicit Frame_Cache(size_t limit = FRAME_CACHE_DEFAULT_BYTES);
+
+    void setLimit(size_t bytes);                // evicts down to the new cap
+    void clear();                               // drops every entry (e.g. when the packets would now be built differently)
+
+    const cached_frames_t* find(const frame_key_t& key);   // 0 on a miss; valid until the cache is next changed
+    uint32_t record(const frame_key_t& key, size_t expected);  // starts a recording ('expected' bytes of packets), returns its id
+    void append(uint32_t id, const uint8_t* packet, int n);    // does nothing unless 'id' is the recording in progress
+    void commit();                              // the recorded downlink completed, it becomes an entry
+    void abort();                               // the recorded downlink failed, it is dropped
+
+    void noteFirstPacket(bool hit, uint64_t wait_ns);
+    const frame_cache_stats_t& getStats() const;
+    void printStats();
+};
+
+#endif // FRAME_CACHE_H
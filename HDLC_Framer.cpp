@@ -0,0 +1,288 @@
+/****************************************************************************
+* HDLC_Framer.cpp
+*
+* @about      : host-side HDLC framing for the transceiver's transparent
+*               mode. Frames carry the payload, a CRC-16/CCITT FCS (as in
+*               AX.25) and flag delimiters, with bit stuffing and an
+*               optional G3RUH scrambler. Every stage works a byte at a time
+*               from lookup tables; the deframer only falls back to single
+*               bits around stuffed zeros and flags.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#include <iostream>
+#include "HDLC_Framer.h"
+
+/* bits go on the line least significant first, as in AX.25 */
+
+
+/*********************** Lookup Tables ***********************/
+
+/* CRC-16/CCITT, reflected (polynomial 0x8408), one step per byte */
+struct fcs_table_t {
+    uint16_t value[256];
+
+    constexpr fcs_table_t() : value() {
+        for (int byte = 0; byte < 256; byte++) {
+            uint16_t crc = byte;
+            for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+            value[byte] = crc;
+        }
+    }
+};
+
+/* the stuffed bits of a byte, given the ones already at the end of the stream (0-4) */
+struct stuff_entry_t {
+    uint16_t bits;                          // up to 10 line bits, first in bit 0
+    uint8_t len;                            // 8-10
+    uint8_t ones;                           // ones at the end of the stream afterwards
+};
+
+struct stuff_table_t {
+    stuff_entry_t value[5][256];
+
+    constexpr stuff_table_t() : value() {
+        for (int ones_in = 0; ones_in < 5; ones_in++) {
+            for (int byte = 0; byte < 256; byte++) {
+                uint16_t bits = 0;
+                uint8_t len = 0, ones = ones_in;
+                for (int bit = 0; bit < 8; bit++) {
+                    uint8_t b = (byte >> bit) & 1;
+                    bits |= b << len++;
+                    ones = b ? ones + 1 : 0;
+                    if (ones == 5) {            // a zero follows every fifth consecutive one
+                        len++;
+                        ones = 0;
+                    }
+                }
+                value[ones_in][byte] = {bits, len, ones};
+            }
+        }
+    }
+};
+
+/* the runs of ones in a byte, used to find the bytes the deframer can take whole */
+struct run_entry_t {
+    uint8_t lead;                           // ones before the first zero (sent first)
+    uint8_t trail;                          // ones after the last zero (sent last)
+    uint8_t longest;                        // longest run anywhere in the byte
+};
+
+struct run_table_t {
+    run_entry_t value[256];
+
+    constexpr run_table_t() : value() {
+        for (int byte = 0; byte < 256; byte++) {
+            uint8_t lead = 0, trail = 0, run = 0, longest = 0;
+            while (lead < 8 && ((byte >> lead) & 1)) lead++;
+            while (trail < 8 && ((byte >> (7 - trail)) & 1)) trail++;
+            for (int bit = 0; bit < 8; bit++) {
+                run = ((byte >> bit) & 1) ? run + 1 : 0;
+                if (run > longest) longest = run;
+            }
+            value[byte] = {lead, trail, longest};
+        }
+    }
+};
+
+static constexpr fcs_table_t fcs_table;
+static constexpr stuff_table_t stuff_table;
+static constexpr run_table_t run_table;
+
+static_assert(stuff_table.value[4][0xFF].len == 10, "a byte of ones after four ones needs two stuffed zeros");
+
+
+/************************** Framer ****************************/
+
+HDLC_Framer::HDLC_Framer(const hdlc_config_t& config) {
+    this->config = config;
+    if (this->config.flags == 0) this->config.flags = 1;     // the padding of the previous frame must be closed by a flag
+    resetStats();
+    reset();
+}
+
+void HDLC_Framer::reset() {
+    tx_scrambler = 0;
+    tx_ones = 0;
+
+    rx_scrambler = 0;
+    rx_ones = 0;
+    rx_hunting = true;
+    rx_bits = 0;
+    rx_acc = 0;
+}
+
+int HDLC_Framer::maxFramedLen(int n) const {
+    /* at most two stuffed zeros per byte, then the closing flag and the padding */
+    return config.flags + ((n + HDLC_FCS_LEN) * 10 + 7) / 8 + 2;
+}
+
+uint16_t HDLC_Framer::fcs(const uint8_t* data, int n) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < n; i++) crc = (crc >> 8) ^ fcs_table.value[(crc ^ data[i]) & 0xFF];
+    return crc ^ 0xFFFF;
+}
+
+/*
+ * G3RUH: s[n] = d[n] ^ s[n-12] ^ s[n-17]. Every tap is at least 12 bits back,
+ * so the 8 bits of a byte depend only on earlier bytes and can be done at once.
+ */
+uint8_t HDLC_Framer::scramble(uint8_t byte) {
+    uint8_t out = byte ^ (tx_scrambler >> 5) ^ tx_scrambler;
+    tx_scrambler = (tx_scrambler >> 8) | ((uint32_t)out << 9);
+    return out;
+}
+
+uint8_t HDLC_Framer::descramble(uint8_t byte) {
+    uint8_t out = byte ^ (rx_scrambler >> 5) ^ rx_scrambler;
+    rx_scrambler = (rx_scrambler >> 8) | ((uint32_t)byte << 9);
+    return out;
+}
+
+int HDLC_Framer::frame(const uint8_t* data, int n, uint8_t* out) {
+    uint64_t acc = 0;                       // line bits not yet written out, first in bit 0
+    int nbits = 0, len = 0;
+    uint16_t crc = fcs(data, n);
+    uint8_t fcs_bytes[HDLC_FCS_LEN] = {(uint8_t)(crc & 0xFF), (uint8_t)(crc >> 8)};
+
+    for (int i = 0; i < config.flags; i++) {
+        acc |= (uint64_t)HDLC_FLAG << nbits;
+        nbits += 8;
+        while (nbits >= 8) { out[len++] = acc; acc >>= 8; nbits -= 8; }
+    }
+    tx_ones = 0;                            // flags are not stuffed
+
+    for (int i = 0; i < n + HDLC_FCS_LEN; i++) {
+        const stuff_entry_t& e = stuff_table.value[tx_ones][(i < n) ? data[i] : fcs_bytes[i - n]];
+        acc |= (uint64_t)e.bits << nbits;
+        nbits += e.len;
+        tx_ones = e.ones;
+        stats.tx_stuffed += e.len - 8;
+        while (nbits >= 8) { out[len++] = acc; acc >>= 8; nbits -= 8; }
+    }
+
+    /* the closing flag, then zeros up to the byte boundary (too short to be taken for a frame) */
+    acc |= (uint64_t)HDLC_FLAG << nbits;
+    nbits += 8;
+    while (nbits > 0) { out[len++] = acc; acc >>= 8; nbits -= 8; }
+
+    if (config.scramble) {
+        for (int i = 0; i < len; i++) out[i] = scramble(out[i]);
+    }
+
+    stats.tx_frames++;
+    stats.tx_payload += n;
+    stats.tx_line_bits += len * 8;
+    return len;
+}
+
+void HDLC_Framer::endFrame(const std::function<void(const uint8_t*, int)>& deliver) {
+    /* the flag's leading zero and six ones were collected as data */
+    if (rx_bits < 7 + 8) {
+        /* back-to-back flags or the padding after one */
+        rx_bits = 0;
+        rx_acc = 0;
+        return;
+    }
+
+    uint32_t bits = rx_bits - 7;
+    if (bits % 8 || bits / 8 <= HDLC_FCS_LEN) {
+        stats.rx_aborts++;
+    } else {
+        int n = bits / 8;
+        uint16_t crc = 0xFFFF;
+        for (int i = 0; i < n; i++) crc = (crc >> 8) ^ fcs_table.value[(crc ^ rx_frame[i]) & 0xFF];
+
+        if (crc == HDLC_FCS_GOOD) {
+            stats.rx_frames++;
+            stats.rx_payload += n - HDLC_FCS_LEN;
+            deliver(rx_frame, n - HDLC_FCS_LEN);
+        } else {
+            stats.rx_fcs_errors++;
+        }
+    }
+
+    rx_bits = 0;
+    rx_acc = 0;
+}
+
+void HDLC_Framer::receiveBit(uint8_t bit, const std::function<void(const uint8_t*, int)>& deliver) {
+    if (bit) {
+        if (++rx_ones == 7) {               // abort: drop the frame and hunt for the next flag
+            if (!rx_hunting && rx_bits > 7) stats.rx_aborts++;
+            rx_hunting = true;
+            rx_bits = 0;
+            rx_acc = 0;
+        }
+    } else {
+        uint8_t ones = rx_ones;
+        rx_ones = 0;
+        if (ones == 5) return;              // stuffed zero
+        if (ones == 6) {                    // flag
+            if (!rx_hunting) endFrame(deliver);
+            rx_hunting = false;
+            rx_bits = 0;
+            rx_acc = 0;
+            return;
+        }
+    }
+    if (rx_hunting || rx_ones >= 7) return;
+
+    rx_acc |= bit << (rx_bits % 8);
+    if (++rx_bits % 8 == 0) {
+        if (rx_bits / 8 > HDLC_MAX_FRAME_LEN) {
+            stats.rx_aborts++;              // too long to be ours: wait for the next flag
+            rx_hunting = true;
+            rx_bits = 0;
+        } else {
+            rx_frame[rx_bits / 8 - 1] = rx_acc;
+        }
+        rx_acc = 0;
+    }
+}
+
+void HDLC_Framer::deframe(const uint8_t* data, int n, const std::function<void(const uint8_t*, int)>& deliver) {
+    for (int i = 0; i < n; i++) {
+        uint8_t byte = config.scramble ? descramble(data[i]) : data[i];
+        const run_entry_t& run = run_table.value[byte];
+
+        /* no stuffed zero, flag or abort can end inside this byte, so it is taken whole (completing one frame byte) */
+        if (!rx_hunting && rx_ones + run.lead < 5 && run.longest < 5 && rx_bits / 8 < HDLC_MAX_FRAME_LEN) {
+            rx_acc |= (uint32_t)byte << (rx_bits % 8);
+            rx_frame[rx_bits / 8] = rx_acc & 0xFF;
+            rx_acc >>= 8;
+            rx_bits += 8;
+            rx_ones = run.trail;
+            continue;
+        }
+
+        for (int bit = 0; bit < 8; bit++) receiveBit((byte >> bit) & 1, deliver);
+    }
+}
+
+const hdlc_stats_t& HDLC_Framer::getStats() const {
+    return stats;
+}
+
+void HDLC_Framer::resetStats() {
+    stats = {0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+void HDLC_Framer::printStats() {
+    double goodput = stats.tx_line_bits ? 100.0 * stats.tx_payload * 8 / stats.tx_line_bits : 0;
+    double frame_len = stats.tx_frames ? (double)stats.tx_payload / stats.tx_frames : 0;
+    double ax25 = frame_len ? 100.0 * frame_len / (frame_len + AX25_UI_OVERHEAD + 1) : 0;
+
+    std::cout << std::dec;
+    std::cout << "HDLC Framer Statistics (" << (config.scramble ? "scrambled" : "unscrambled") << "):" << std::endl;
+    std::cout << "\tTx Frames: " << stats.tx_frames << ", Payload: " << stats.tx_payload << " bytes, Line: " << stats.tx_line_bits / 8
+              << " bytes, Stuffed Bits: " << stats.tx_stuffed << std::endl;
+    std::cout << "\tGoodput: " << goodput << "% (AX.25 UI header and FCS at the same payload, before stuffing: " << ax25 << "%)" << std::endl;
+    std::cout << "\tRx Frames: " << stats.rx_frames << ", Payload: " << stats.rx_payload << " bytes, FCS Errors: " << stats.rx_fcs_errors
+              << ", Aborts: " << stats.rx_aborts << std::endl;
+}
@@ -0,0 +1,95 @@
+/****************************************************************************
+* HDLC_Framer.h
+*
+* @about      : host-side HDLC framing for the transceiver's transparent
+*               mode. Frames carry the payload, a CRC-16/CCITT FCS (as in
+*               AX.25) and flag delimiters, with bit stuffing and an
+*               optional G3RUH scrambler. Every stage works a byte at a time
+*               from lookup tables; the deframer only falls back to single
+*               bits around stuffed zeros and flags.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef HDLC_FRAMER_H
+#define HDLC_FRAMER_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <functional>
+
+
+/************************** Defines ***************************/
+
+#define HDLC_FLAG               0x7E
+#define HDLC_FCS_LEN            2           // CRC-16/CCITT, sent low byte first
+#define HDLC_FCS_GOOD           0xF0B8      // residue of a CRC run over a frame and its FCS
+#define HDLC_MAX_FRAME_LEN      512         // longest frame (payload + FCS) the deframer accepts
+#define HDLC_DEFAULT_FLAGS      1           // opening flags per frame (consecutive frames share the closing one)
+#define AX25_UI_OVERHEAD        18          // address (14), control, PID and FCS bytes of an AX.25 UI frame
+
+
+struct hdlc_config_t {
+    bool scramble;                          // G3RUH (1 + x^12 + x^17) scrambling of the line bits
+    uint8_t flags;                          // opening flags per frame
+};
+
+struct hdlc_stats_t {
+    uint64_t tx_frames;                     // frames built
+    uint64_t tx_payload;                    // payload bytes framed
+    uint64_t tx_line_bits;                  // bits put on the line (flags, stuffing and padding included)
+    uint64_t tx_stuffed;                    // zero bits inserted by the stuffer
+    uint64_t rx_frames;                     // frames delivered with a good FCS
+    uint64_t rx_payload;                    // payload bytes delivered
+    uint64_t rx_fcs_errors;                 // frames dropped for a bad FCS
+    uint64_t rx_aborts;                     // frames dropped by an abort sequence, misalignment or overflow
+};
+
+
+/************************** Framer ****************************/
+
+class HDLC_Framer {
+private:
+    hdlc_config_t config;
+    hdlc_stats_t stats;
+
+    /* transmit */
+    uint32_t tx_scrambler;                  // last 17 line bits sent, oldest in bit 0
+    uint8_t tx_ones;                        // ones at the end of the stuffed stream
+
+    /* receive */
+    uint32_t rx_scrambler;                  // last 17 line bits received, oldest in bit 0
+    uint8_t rx_ones;                        // consecutive ones received
+    bool rx_hunting;                        // no flag seen since the last abort
+    uint32_t rx_bits;                       // bits collected since the last flag
+    uint32_t rx_acc;                        // partial byte of the frame being received
+    uint8_t rx_frame[HDLC_MAX_FRAME_LEN + 1];
+
+    uint8_t scramble(uint8_t byte);
+    uint8_t descramble(uint8_t byte);
+    void receiveBit(uint8_t bit, const std::function<void(const uint8_t*, int)>& deliver);
+    void endFrame(const std::function<void(const uint8_t*, int)>& deliver);
+
+public:
+    explicit HDLC_Framer(const hdlc_config_t& config = {false, HDLC_DEFAULT_FLAGS});
+    void reset();                                               // restarts both directions (e.g. after a mode change)
+
+    int maxFramedLen(int n) const;                              // worst-case size of frame() for an n-byte payload
+    static uint16_t fcs(const uint8_t* data, int n);            // CRC-16/CCITT frame check sequence
+
+    int frame(const uint8_t* data, int n, uint8_t* out);        // builds a byte-aligned frame, returns its length
+    void deframe(const uint8_t* data, int n,
+                 const std::function<void(const uint8_t*, int)>& deliver);     // feeds line bytes, delivers each good payload
+
+    const hdlc_stats_t& getStats() const;
+    void resetStats();
+    void printStats();
+};
+
+#endif //HDLC_FRAMER_H
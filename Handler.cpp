@@ -13,41 +13,197 @@
 #include "Handler.h"
 #include "Actions.h"
 #include "ManageHistory.h"
+#include "Log.h"
 
 
-Handler::Handler(UHF_Transceiver* transceiver) {
-    packager = new Packager(transceiver);
+template <class Bus>
+Handler<Bus>::Handler(UHF_Transceiver<Bus>* transceiver, File_Worker* files) {
+    packager = new Packager<Bus>(transceiver);
+    this->files = files;
+    downlinking = false;
+    downlink_cacheable = false;
+    pumping = false;
+    compress = false;
+    ready_buffer = 0;
+    ready_len = -1;
 }
 
-int Handler::process(command_t* inbound_command) {
+template <class Bus>
+int Handler<Bus>::process(command_t* inbound_command) {
     int status = identify_response(inbound_command);
     return status;
 }
 
-void Handler::sendFile(std::string filename) {
-    packager->sendFile(filename);
+template <class Bus>
+void Handler<Bus>::setFramer(HDLC_Framer* framer) {
+    packager->setFramer(framer);
 }
 
-void Handler::sendSignal(uint8_t signal) {
+template <class Bus>
+void Handler<Bus>::setCompression(bool enable) {
+    compress = enable;
+    packager->setCompression(enable);
+}
+
+template <class Bus>
+void Handler<Bus>::setCacheLimit(size_t bytes) {
+    packager->getCache().setLimit(bytes);
+}
+
+template <class Bus>
+void Handler<Bus>::printStats() {
+    packager->printStats();
+}
+
+template <class Bus>
+void Handler<Bus>::sendFile(std::string filename, std::function<void()> prepare) {
+    downlinks.emplace_back(filename, prepare);
+    if (!downlinking) startDownlink();
+}
+
+/*
+ * The file is read on the file thread a chunk at a time and framed on the service thread, so only two chunks
+ * are ever in memory. With the file worker running inline, the whole downlink goes out before this returns.
+ */
+template <class Bus>
+void Handler<Bus>::startDownlink() {
+    if (downlinks.empty()) return;
+
+    std::string filename = downlinks.front().first;
+    std::function<void()> prepare = downlinks.front().second;
+    downlinks.pop_front();
+    downlinking = true;
+
+    downlink_name = filename;
+    requested = std::chrono::steady_clock::now();
+    /* every command is logged in the history, this request included, so its packets could never be sent again */
+    downlink_cacheable = (filename != HISTORY_FILENAME);
+
+    /* the file is only looked at first: it is not read at all when its packets are still cached */
+    files->submit([this, filename, prepare]() {
+        if (prepare) prepare();
+        return downlink_key.load(filename);
+    }, [this](int status) {
+        const cached_frames_t* frames = (status < 0 || !downlink_cacheable) ? nullptr : packager->getCache().find(downlink_key);
+        if (!frames) {
+            readDownlink();
+            return;
+        }
+        packager->getCache().noteFirstPacket(true, waited());
+        packager->sendFrames(frames);
+        finishDownlink();
+    });
+}
+
+template <class Bus>
+void Handler<Bus>::readDownlink() {
+    std::string filename = downlink_name;
+    bool pack = compress;
+    files->submit([this, filename, pack]() {
+        if (downlink_file.open(filename, pack) < 0) return -1;
+        return downlink_file.readChunk(0);
+    }, [this](int len) {
+        uint8_t telecom = downlink_file.packed ? TELECOM_DOWNLINK_FILE_LZ : TELECOM_DOWNLINK_FILE;
+        if (len < 0 || packager->beginStream(&downlink_stream, telecom, downlink_file.size) < 0) {
+            packager->sendFileUnavailable();
+            finishDownlink();
+            return;
+        }
+        if (downlink_cacheable) {
+            packager->getCache().noteFirstPacket(false, waited());
+            downlink_stream.recording = packager->getCache().record(downlink_file.key, (size_t)downlink_stream.num_packets * PACKET_MAX_LEN);
+        }
+        chunkReady(0, len);
+    });
+}
+
+template <class Bus>
+uint64_t Handler<Bus>::waited() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - requested).count();
+}
+
+template <class Bus>
+void Handler<Bus>::chunkReady(int buffer, int len) {
+    if (len < 0) {
+        LOG_ERROR("Unable to read the rest of the file, the downlink ends after packet %u.", (unsigned)downlink_stream.next_packet - 1);
+        packager->endStream(&downlink_stream);
+        packager->getCache().abort();
+        finishDownlink();
+        return;
+    }
+
+    ready_buffer = buffer;
+    ready_len = len;
+    if (!pumping) pumpDownlink();
+}
+
+template <class Bus>
+void Handler<Bus>::pumpDownlink() {
+    pumping = true;
+
+    while (ready_len >= 0) {
+        int buffer = ready_buffer;
+        int len = ready_len;
+        ready_len = -1;
+
+        /* no read is outstanding here, so the file's offset is ours to look at */
+        bool last = downlink_file.done();
+        if (!last) {
+            files->submit([this, buffer]() { return downlink_file.readChunk(buffer ^ 1); },
+                          [this, buffer](int next_len) { chunkReady(buffer ^ 1, next_len); });
+        }
+
+        packager->streamChunk(&downlink_stream, std::string_view((const char*)downlink_file.buffers[buffer], len));
+        if (last) {
+            packager->endStream(&downlink_stream);
+            packager->getCache().commit();
+            if (downlink_file.packed) packager->recordPacked(downlink_name.c_str(), downlink_file.raw_size, downlink_file.size, downlink_file.cpu_ns);
+            finishDownlink();
+        }
+    }
+
+    pumping = false;
+}
+
+template <class Bus>
+void Handler<Bus>::finishDownlink() {
+    files->submit([this]() { downlink_file.close(); return 0; });
+    downlinking = false;
+    startDownlink();
+}
+
+template <class Bus>
+void Handler<Bus>::retransmit(const std::string& ranges) {
+    int resent = packager->retransmit(ranges);
+    if (resent < 0)       sendSignal(TELECOM_PACKET_FORMAT_ERR);
+    else if (resent == 0) packager->sendFileUnavailable();      // none are kept anymore: the ground has to request the file again
+}
+
+template <class Bus>
+void Handler<Bus>::sendSignal(uint8_t signal) {
     std::string out_str;
     out_str += (char)signal;
     packager->sendString(out_str);
 }
 
-void Handler::acknowledge(void) {
+template <class Bus>
+void Handler<Bus>::acknowledge(void) {
     sendSignal(ACKNOWLEDGE);
 }
 
-void Handler::sendError(void) {
+template <class Bus>
+void Handler<Bus>::sendError(void) {
     sendSignal(ERROR);
 }
 
-void Handler::sendStatus(uint8_t status) {
+template <class Bus>
+void Handler<Bus>::sendStatus(uint8_t status) {
     if (status < 0) sendError();
     else            acknowledge();
 }
 
-int Handler::identify_response(command_t* inbound_command) {
+template <class Bus>
+int Handler<Bus>::identify_response(command_t* inbound_command) {
     int status = 0;
     uint8_t telecom = inbound_command->telecommand;
     std::string params = inbound_command->params;
@@ -60,16 +216,18 @@ int Handler::identify_response(command_t* inbound_command) {
             sendFile(params);
             break;
         case TELECOM_UNDO_UPLOAD:
-            status = undoUpload(params);
-            sendStatus(status);
+            files->submit([params]() { return undoUpload(params); },
+                          [this](int status) { sendStatus(status); });
             break;
         case TELECOM_GET_HISTORY:
-            cleanHistory();
-            sendFile(HISTORY_FILENAME);
+            sendFile(HISTORY_FILENAME, cleanHistory);
             break;
         case TELECOM_GET_HEALTH:
             sendFile("health.csv");
             break;
+        case TELECOM_RETRANSMIT:
+            retransmit(params);
+            break;
         case TELECOM_DEBUG_ON:
             debug_led_on(0);
             acknowledge();
@@ -104,20 +262,28 @@ int Handler::identify_response(command_t* inbound_command) {
     return status;
 }
 
-Handler::~Handler() {
+template <class Bus>
+Handler<Bus>::~Handler() {
+    downlink_file.close();
     delete(packager);
 }
 
 /****************************** Test Functions *****************************/
 
-void Handler::debug_led_on(int led) {
+template <class Bus>
+void Handler<Bus>::debug_led_on(int led) {
     packager->debug_on(led);
 }
 
-void Handler::debug_led_off(int led) {
+template <class Bus>
+void Handler<Bus>::debug_led_off(int led) {
     packager->debug_off(led);
 }
 
-void Handler::debug_led_toggle(int led) {
+template <class Bus>
+void Handler<Bus>::debug_led_toggle(int led) {
     packager->debug_toggle(led);
-}
\ No newline at end of file
+}
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class Handler<I2C_Bus>;
@@ -19,19 +19,46 @@
 #include <cstdio>
 #include <ctime>
 #include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <utility>
 #include "telecommands.h"
 #include "UHF_Transceiver.h"
 #include "Interpreter.h"
 #include "Packager.h"
+#include "File_Worker.h"
 
 
 /************************** Handler ***************************/
+template <class Bus>
 class Handler {
 private:
-    Packager* packager;
+    Packager<Bus>* packager;
+    File_Worker* files;                             // history, health and downlinked files are read here, off the service thread
+
+    /* File downlink: a chunk is framed while the next one is read */
+    downlink_file_t downlink_file;
+    downlink_stream_t downlink_stream;
+    std::deque<std::pair<std::string, std::function<void()>>> downlinks;   // requested while another file was going down
+    std::string downlink_name;                      // the file going down now
+    frame_key_t downlink_key;                       // and its key in the packager's cache when it was requested
+    bool downlink_cacheable;                        // whether its packets are looked up in and kept by the cache
+    std::chrono::steady_clock::time_point requested;
+    bool compress;                                  // files that shrink go down as TELECOM_DOWNLINK_FILE_LZ
+    bool downlinking;
+    bool pumping;                                   // framing chunks (a chunk that arrives meanwhile is picked up by the same loop)
+    int ready_buffer;                               // chunk read and waiting to be framed
+    int ready_len;                                  // its length (-1: none)
 
     int identify_response(command_t* inbound_command);
-    void sendFile(std::string filename);
+    void sendFile(std::string filename, std::function<void()> prepare = nullptr);
+    void startDownlink();
+    void readDownlink();
+    uint64_t waited() const;                        // since the downlink was requested (ns)
+    void chunkReady(int buffer, int len);
+    void pumpDownlink();
+    void finishDownlink();
+    void retransmit(const std::string& ranges);
     void sendSignal(uint8_t signal);
     void acknowledge(void);
     void sendError(void);
@@ -43,8 +70,12 @@ private:
     void debug_led_toggle(int led);
 
 public:
-    explicit Handler(UHF_Transceiver* transceiver);
+    Handler(UHF_Transceiver<Bus>* transceiver, File_Worker* files);
     int process(command_t* inbound_command);
+    void setFramer(HDLC_Framer* framer);            // host-side framing of the responses (0 in AX.25 mode)
+    void setCompression(bool enable);               // compresses downlinked files and strings (applies from the next downlink)
+    void setCacheLimit(size_t bytes);               // memory kept for the packets of repeated downlinks (0 disables the cache)
+    void printStats();
     ~Handler();
 };
 
@@ -0,0 +1,151 @@
+ /****************************************************************************
+ * I2C_Arbiter.cpp
+ *
+ * @about      : grants access to a shared I2C bus by priority class. Data
+ *               transfers (RX drain, TX refill) go ahead of commands, which
+ *               go ahead of telemetry; waiters that keep being overtaken are
+ *               promoted so that no class starves.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include "I2C_Arbiter.h"
+
+static thread_local int current_priority = I2C_PRIORITY_COMMAND;
+static const char* priority_names[I2C_NUM_PRIORITIES] = {"Data", "Command", "Telemetry"};
+
+static uint64_t monotonic_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+I2C_Arbiter::I2C_Arbiter() {
+	busy = false;
+	waiters = 0;
+	next_ticket = 0;
+	resetStats();
+}
+
+I2C_Arbiter& I2C_Arbiter::forBus(uint8_t bus) {
+	static I2C_Arbiter arbiters[I2C_ARBITER_MAX_BUSES];
+	if (bus >= I2C_ARBITER_MAX_BUSES) bus = I2C_ARBITER_MAX_BUSES - 1;	// i2c_open rejects these anyway
+	return arbiters[bus];
+}
+
+int I2C_Arbiter::effectivePriority(const waiter_t* waiter) {
+	int promoted = waiter->priority - (int)(waiter->bypassed / I2C_ARBITER_AGING);
+	return promoted < 0 ? 0 : promoted;
+}
+
+void I2C_Arbiter::grantNext() {
+	waiter_t** best = &waiters;
+	for (waiter_t** w = &waiters; *w; w = &(*w)->next) {
+		int p = effectivePriority(*w), best_p = effectivePriority(*best);
+		if (p < best_p || (p == best_p && (*w)->ticket < (*best)->ticket)) best = w;
+	}
+
+	waiter_t* winner = *best;
+	*best = winner->next;
+
+	/* everyone who arrived earlier has just been overtaken */
+	for (waiter_t* w = waiters; w; w = w->next) {
+		if (w->ticket < winner->ticket) {
+			w->bypassed++;
+			stats.bypasses[w->priority]++;
+		}
+	}
+	if (effectivePriority(winner) < winner->priority) stats.promotions[winner->priority]++;
+
+	winner->granted = true;										// the bus stays busy: ownership passes directly
+	winner->wakeup.notify_one();
+}
+
+void I2C_Arbiter::acquire() {
+	int priority = I2C_PriorityScope::current();
+	std::unique_lock<std::mutex> guard(lock);
+
+	stats.grants[priority]++;
+	if (!busy) {
+		busy = true;
+		return;
+	}
+
+	waiter_t self;
+	self.priority = priority;
+	self.ticket = next_ticket++;
+	self.bypassed = 0;
+	self.granted = false;
+	self.next = waiters;
+	waiters = &self;
+
+	uint64_t start = monotonic_ns();
+	while (!self.granted) self.wakeup.wait(guard);
+	uint64_t waited = monotonic_ns() - start;
+
+	stats.contended[priority]++;
+	stats.total_wait_ns[priority] += waited;
+	if (waited > stats.max_wait_ns[priority]) stats.max_wait_ns[priority] = waited;
+	if (waited > I2C_ARBITER_STARVATION_MS * 1000000ULL) stats.starved[priority]++;
+}
+
+void I2C_Arbiter::release() {
+	std::lock_guard<std::mutex> guard(lock);
+	if (waiters) grantNext();
+	else 		 busy = false;
+}
+
+i2c_arbiter_stats_t I2C_Arbiter::getStats() {
+	std::lock_guard<std::mutex> guard(lock);
+	return stats;
+}
+
+void I2C_Arbiter::resetStats() {
+	memset(&stats, 0, sizeof(stats));
+}
+
+void I2C_Arbiter::printStats() {
+	i2c_arbiter_stats_t s = getStats();
+
+	std::cout << std::dec;
+	std::cout << "I2C Arbiter Statistics:" << std::endl;
+	for (int p = 0; p < I2C_NUM_PRIORITIES; p++) {
+		if (!s.grants[p]) continue;
+		std::cout << "\t" << priority_names[p] << ": Grants: " << s.grants[p] << ", Contended: " << s.contended[p]
+				  << ", Bypassed: " << s.bypasses[p] << ", Promoted: " << s.promotions[p] << ", Starved: " << s.starved[p]
+				  << ", Avg Wait: " << (s.contended[p] ? s.total_wait_ns[p] / s.contended[p] / 1000.0 : 0) << " us"
+				  << ", Max Wait: " << s.max_wait_ns[p] / 1000.0 << " us" << std::endl;
+	}
+}
+
+
+/************************** Grant *****************************/
+
+I2C_Grant::I2C_Grant(I2C_Arbiter& arbiter) : arbiter(arbiter) {
+	arbiter.acquire();
+}
+
+I2C_Grant::~I2C_Grant() {
+	arbiter.release();
+}
+
+
+/*********************** Priority Scope ***********************/
+
+I2C_PriorityScope::I2C_PriorityScope(int priority) {
+	previous = current_priority;
+	current_priority = priority;
+}
+
+I2C_PriorityScope::~I2C_PriorityScope() {
+	current_priority = previous;
+}
+
+int I2C_PriorityScope::current() {
+	return current_priority;
+}
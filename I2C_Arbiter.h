@@ -0,0 +1,115 @@
+/****************************************************************************
+* I2C_Arbiter.h
+*
+* @about      : grants access to a shared I2C bus by priority class. Data
+*               transfers (RX drain, TX refill) go ahead of commands, which
+*               go ahead of telemetry; waiters that keep being overtaken are
+*               promoted so that no class starves.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_ARBITER
+#define I2C_ARBITER
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+
+
+/*************************** Defines ***************************/
+
+#define I2C_PRIORITY_DATA			0		// RX FIFO drain and TX FIFO refill
+#define I2C_PRIORITY_COMMAND		1		// configuration and control (default)
+#define I2C_PRIORITY_TELEMETRY		2		// housekeeping reads
+#define I2C_NUM_PRIORITIES			3
+
+#define I2C_ARBITER_AGING			4		// times a waiter may be overtaken before it is promoted one class
+#define I2C_ARBITER_STARVATION_MS	100		// waits longer than this are counted as starvation
+#define I2C_ARBITER_MAX_BUSES		10		// /dev/i2c-0 to /dev/i2c-9 (see i2c_open)
+
+
+struct i2c_arbiter_stats_t {
+	uint32_t grants[I2C_NUM_PRIORITIES];		// times the bus was granted
+	uint32_t contended[I2C_NUM_PRIORITIES];		// grants that had to wait for another holder
+	uint32_t bypasses[I2C_NUM_PRIORITIES];		// times a waiter was overtaken by a later arrival
+	uint32_t promotions[I2C_NUM_PRIORITIES];	// grants won only because of aging
+	uint32_t starved[I2C_NUM_PRIORITIES];		// waits longer than I2C_ARBITER_STARVATION_MS
+	uint64_t total_wait_ns[I2C_NUM_PRIORITIES];
+	uint64_t max_wait_ns[I2C_NUM_PRIORITIES];
+};
+
+
+/*************************** Arbiter ***************************/
+
+class I2C_Arbiter {
+private:
+	/* every blocked caller links one of these (on its own stack) into the wait list */
+	struct waiter_t {
+		int priority;
+		uint64_t ticket;						// arrival order
+		uint32_t bypassed;						// later arrivals granted ahead of this waiter
+		bool granted;
+		std::condition_variable wakeup;
+		waiter_t* next;
+	};
+
+	std::mutex lock;
+	bool busy;
+	waiter_t* waiters;
+	uint64_t next_ticket;
+	i2c_arbiter_stats_t stats;
+
+	static int effectivePriority(const waiter_t* waiter);	// class after aging
+	void grantNext();											// hands the bus to the best waiter (lock held)
+
+public:
+	I2C_Arbiter();
+	I2C_Arbiter(const I2C_Arbiter&) = delete;
+	I2C_Arbiter& operator=(const I2C_Arbiter&) = delete;
+
+	static I2C_Arbiter& forBus(uint8_t bus);					// the arbiter shared by every device on a bus
+
+	void acquire();												// blocks until the bus is granted at the caller's priority
+	void release();												// passes the bus to the next waiter
+	i2c_arbiter_stats_t getStats();								// fetches the arbitration statistics
+	void resetStats();											// clears the arbitration statistics
+	void printStats();											// prints the arbitration statistics
+};
+
+/* Holds the bus for the lifetime of the object (like std::lock_guard). */
+class I2C_Grant {
+private:
+	I2C_Arbiter& arbiter;
+
+public:
+	explicit I2C_Grant(I2C_Arbiter& arbiter);
+	I2C_Grant(const I2C_Grant&) = delete;
+	I2C_Grant& operator=(const I2C_Grant&) = delete;
+	~I2C_Grant();
+};
+
+/* Sets the priority of every bus request issued by this thread during its lifetime (the innermost scope wins). */
+class I2C_PriorityScope {
+private:
+	int previous;
+
+public:
+	explicit I2C_PriorityScope(int priority);
+	I2C_PriorityScope(const I2C_PriorityScope&) = delete;
+	I2C_PriorityScope& operator=(const I2C_PriorityScope&) = delete;
+	~I2C_PriorityScope();
+
+	static int current();										// priority of the calling thread
+};
+
+#define I2C_PRIORITY(priority)		I2C_PriorityScope i2c_priority_scope(priority)
+
+#endif // I2C_ARBITER
@@ -0,0 +1,73 @@
+ /****************************************************************************
+ * I2C_Batch.cpp
+ *
+ * @about      : queues register reads and writes so that they can be sent
+ *               as a single I2C_RDWR transaction.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <string.h>
+#include "I2C_Batch.h"
+#include "I2C_Functions.h"
+
+I2C_Batch::I2C_Batch() {
+	endianness = C_BIG_ENDIAN;
+	retry = true;
+	clear();
+}
+
+int I2C_Batch::read(uint8_t reg, int n) {
+	if (num_ops == I2C_BATCH_MAX_OPS || num_received + n > I2C_BATCH_MAX_DATA) return -1;
+
+	ops[num_ops] = {reg, true, n, num_received};
+	num_received += n;
+	return num_ops++;
+}
+
+int I2C_Batch::write(uint8_t reg, uint8_t data) {
+	return writen(reg, &data, 1);
+}
+
+int I2C_Batch::writen(uint8_t reg, const uint8_t* data, int n) {
+	if (num_ops == I2C_BATCH_MAX_OPS || num_written + n > I2C_BATCH_MAX_DATA) return -1;
+
+	ops[num_ops] = {reg, false, n, num_written};
+	memcpy(&written[num_written], data, n);
+	num_written += n;
+	return num_ops++;
+}
+
+void I2C_Batch::setRetry(bool retry) {
+	this->retry = retry;
+}
+
+void I2C_Batch::clear() {
+	num_ops = 0;
+	num_written = 0;
+	num_received = 0;
+	memset(received, 0, sizeof(received));
+}
+
+int I2C_Batch::size() const {
+	return num_ops;
+}
+
+uint8_t I2C_Batch::get8(int handle) const {
+	return received[ops[handle].offset];
+}
+
+uint16_t I2C_Batch::get16(int handle) const {
+	const uint8_t* data = &received[ops[handle].offset];
+
+	if (endianness == C_BIG_ENDIAN) return (((uint16_t)data[0])<<8) | ((uint16_t)data[1]);
+	else 						    return (((uint16_t)data[1])<<8) | ((uint16_t)data[0]);
+}
+
+const uint8_t* I2C_Batch::getn(int handle) const {
+	return &received[ops[handle].offset];
+}
@@ -0,0 +1,67 @@
+/****************************************************************************
+* I2C_Batch.h
+*
+* @about      : queues register reads and writes so that they can be sent
+*               as a single I2C_RDWR transaction.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_BATCH
+#define I2C_BATCH
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+
+
+/*************************** Defines ***************************/
+
+#define I2C_BATCH_MAX_OPS		32		// most operations a batch can hold
+#define I2C_BATCH_MAX_DATA		256		// most bytes a batch can read (and, separately, write)
+#define I2C_BATCH_READ_SEGMENTS	2		// register pointer write + restarted read
+#define I2C_BATCH_WRITE_SEGMENTS 1		// register pointer + data
+
+
+/**************************** Batch ****************************/
+
+template <class Bus> class I2C_Functions;
+
+class I2C_Batch {
+	template <class Bus> friend class I2C_Functions;
+
+private:
+	struct op_t {
+		uint8_t reg;					// first register of the operation
+		bool is_read;					// read or write
+		int len;						// number of bytes read or written
+		int offset;						// offset into 'received' (reads) or 'written' (writes)
+	};
+
+	op_t ops[I2C_BATCH_MAX_OPS];
+	uint8_t written[I2C_BATCH_MAX_DATA];	// data bytes of every queued write
+	uint8_t received[I2C_BATCH_MAX_DATA];	// data bytes of every queued read, filled in by I2C_Functions<Bus>::execute()
+	int num_ops, num_written, num_received;
+	bool endianness;
+	bool retry;							// the batch may be sent again after a failure (see I2C_Session::transfer)
+
+public:
+	I2C_Batch();
+	int read(uint8_t reg, int n = 1);							// queues an n-byte read, returns the handle of its result (-1 if full)
+	int write(uint8_t reg, uint8_t data);						// queues a 1-byte write
+	int writen(uint8_t reg, const uint8_t* data, int n);		// queues an n-byte write into consecutive registers
+	void clear();												// removes all queued operations
+	void setRetry(bool retry);									// false for batches that are not idempotent (e.g. that stream into a FIFO)
+	int size() const;											// number of queued operations
+
+	uint8_t get8(int handle) const;								// fetches the result of a 1-byte read
+	uint16_t get16(int handle) const;							// fetches the result of a 2-byte read
+	const uint8_t* getn(int handle) const;						// fetches the result of an n-byte read
+};
+
+#endif // I2C_BATCH
@@ -12,45 +12,49 @@
 
 #include "I2C_Functions.h"
 
-I2C_Functions::I2C_Functions() {
+template <class Bus>
+I2C_Functions<Bus>::I2C_Functions() : session(0), arbiter(I2C_Arbiter::forBus(0)) {
 	I2CBus = 0;
 	set_address(0);
 }
 
-I2C_Functions::I2C_Functions(uint8_t bus, uint8_t device_addr, bool endianness) {
+template <class Bus>
+I2C_Functions<Bus>::I2C_Functions(uint8_t bus, uint8_t device_addr, bool endianness) : session(bus), arbiter(I2C_Arbiter::forBus(bus)) {
 	I2CBus = bus;
-	std::cout << "New Device Created! Device Address: " << std::hex << static_cast<int>(device_addr) << "\n" << std::endl;
+	LOG_INFO("New Device Created! Device Address: %x", device_addr);
 	set_address(device_addr);
 	this->endianness = endianness;
 }
 
-void I2C_Functions::set_address(uint8_t new_addr) {
+template <class Bus>
+void I2C_Functions<Bus>::set_address(uint8_t new_addr) {
 	I2CAddr_Write = (new_addr << 1) | 0;
 	I2CAddr_Read = (new_addr << 1) | 1;
 
 	if (new_addr != 0) {
-		std::cout << "Device Write Address: " << std::hex << static_cast<int>(I2CAddr_Write) << std::endl;
-		std::cout << "Device Read Address: " << std::hex << static_cast<int>(I2CAddr_Read) << std::endl;
+		LOG_INFO("Device Write Address: %x, Read Address: %x", I2CAddr_Write, I2CAddr_Read);
 	}
 }
 
-uint8_t I2C_Functions::get_address() {
+template <class Bus>
+uint8_t I2C_Functions<Bus>::get_address() {
 	return (I2CAddr_Write >> 1) & 0x7F;
 }
 
-int I2C_Functions::write(uint8_t reg, uint8_t data) {
+template <class Bus>
+int I2C_Functions<Bus>::write(uint8_t reg, uint8_t data) {
+	I2C_Grant grant(arbiter);
 	int status; 
 
-	uint16_t write_sequence[] = {I2CAddr_Write, reg, data};
-
-	int handle = i2c_open(I2CBus);
-	status = i2c_send_sequence(handle, write_sequence, 3, 0);
-	i2c_close(handle);
+	I2C_PROFILE_TIMER(timer);
+	status = session.writeBlock(get_address(), reg, &data, 1);
+	I2C_PROFILE_RECORD(timer, reg, I2C_OP_WRITE, 1);
 
 	return status;
 }
 
-int I2C_Functions::write2(uint8_t reg, uint16_t data) {
+template <class Bus>
+int I2C_Functions<Bus>::write2(uint8_t reg, uint16_t data) {
 	int status; 
 
 	uint8_t low = (data >> 0) & 0xFF;
@@ -67,43 +71,43 @@ int I2C_Functions::write2(uint8_t reg, uint16_t data) {
 	return status;
 }
 
-int I2C_Functions::writen(uint8_t reg, uint8_t* data, int n) {
-	int status; 
-
-	int m = 2;									// initial write sequence length
-	int write_seq_len = n+m;
-	uint16_t write_sequence[write_seq_len] = {I2CAddr_Write, reg};
-	int j = 0;									// data byte counter
-	for (int i = m; i < write_seq_len; i++) {
-		print_uint8("I2C", data[j]);
-		write_sequence[i] = data[j++];
+template <class Bus>
+int I2C_Functions<Bus>::writen(uint8_t reg, const uint8_t* data, int n, bool retry) {
+	I2C_Grant grant(arbiter);
+	if (n < 0 || n > I2C_MAX_TRANSFER_LEN) {
+		LOG_ERROR("Unable to write %d bytes in one transaction.", n);
+		return -1;
 	}
 
-	int handle = i2c_open(I2CBus);
-	status = i2c_send_sequence(handle, write_sequence, write_seq_len, 0);
-	i2c_close(handle);
+	LOG_DEBUG("Writing %d bytes to register 0x%02X.", n, reg);
+
+	I2C_PROFILE_TIMER(timer);
+	int status = session.writeBlock(get_address(), reg, data, n, retry);
+	I2C_PROFILE_RECORD(timer, reg, I2C_OP_WRITE, n);
 
 	return status;
 }
 
-uint8_t I2C_Functions::read(uint8_t reg) {
-	uint16_t read_sequence[] = {I2CAddr_Write, reg, I2C_RESTART, I2CAddr_Read, I2C_READ};
+template <class Bus>
+uint8_t I2C_Functions<Bus>::read(uint8_t reg) {
+	I2C_Grant grant(arbiter);
 	uint8_t data_received[1] = {0};
 
-	int handle = i2c_open(I2CBus);
-	i2c_send_sequence(handle, read_sequence, 5, &data_received[0]);
-	i2c_close(handle);
+	I2C_PROFILE_TIMER(timer);
+	session.readBlock(get_address(), reg, &data_received[0], 1);
+	I2C_PROFILE_RECORD(timer, reg, I2C_OP_READ, 1);
 
 	return data_received[0];
 }
 
-uint16_t I2C_Functions::read2(uint8_t reg) {
-	uint16_t read_sequence[] = {I2CAddr_Write, reg, I2C_RESTART, I2CAddr_Read, I2C_READ, I2C_READ};
+template <class Bus>
+uint16_t I2C_Functions<Bus>::read2(uint8_t reg) {
+	I2C_Grant grant(arbiter);
 	uint8_t data_received[2] = {0};
 
-	int handle = i2c_open(I2CBus);
-	i2c_send_sequence(handle, read_sequence, 6, &data_received[0]);
-	i2c_close(handle);
+	I2C_PROFILE_TIMER(timer);
+	session.readBlock(get_address(), reg, &data_received[0], 2);
+	I2C_PROFILE_RECORD(timer, reg, I2C_OP_READ, 2);
 
 	uint16_t data_read;
 	if (endianness == C_BIG_ENDIAN) data_read = (((uint16_t)data_received[0])<<8) | ((uint16_t)data_received[1]);
@@ -112,28 +116,94 @@ uint16_t I2C_Functions::read2(uint8_t reg) {
 	return data_read;
 }
 
-uint8_t* I2C_Functions::readn(uint8_t reg, int n, uint8_t* data_received) {
+template <class Bus>
+uint8_t* I2C_Functions<Bus>::readn(uint8_t reg, int n, uint8_t* data_received, bool retry) {
+	I2C_Grant grant(arbiter);
 	/* requires {uint8_t data[n];} prior to call. the values are returned in the 'data' variable. */
-	int m = 4;					// initial read sequence length
-	int read_seq_len = m+n;
-	uint16_t read_sequence[read_seq_len] = {I2CAddr_Write, reg, I2C_RESTART, I2CAddr_Read};
-	for (int i = m; i < read_seq_len; i++) {
-		read_sequence[i] = I2C_READ;
+	if (n < 0 || n > I2C_MAX_TRANSFER_LEN) {
+		LOG_ERROR("Unable to read %d bytes in one transaction.", n);
+		return 0;
 	}
 
-	int handle = i2c_open(I2CBus);
-	i2c_send_sequence(handle, read_sequence, read_seq_len, &data_received[0]);
-	i2c_close(handle);
+	I2C_PROFILE_TIMER(timer);
+	int status = session.readBlock(get_address(), reg, &data_received[0], n, retry);
+	I2C_PROFILE_RECORD(timer, reg, I2C_OP_READ, n);
+	if (status < 0) return 0;
 
 	return data_received;
 }
 
+template <class Bus>
+int I2C_Functions<Bus>::execute(I2C_Batch* batch) {
+	I2C_Grant grant(arbiter);
+	/* each operation becomes one or two RESTART-separated segments; a single ioctl takes at most I2C_MAX_SEGMENTS */
+	int status = 0;
+	int i = 0;
+	batch->endianness = endianness;
+
+	while (i < batch->num_ops) {
+		uint8_t* data_received = 0;
+		uint32_t seq_len = 0;
+		int segments = 0;
+		int bytes = 0;
+
+		for (; i < batch->num_ops; i++) {
+			const I2C_Batch::op_t& op = batch->ops[i];
+			int op_segments = op.is_read ? I2C_BATCH_READ_SEGMENTS : I2C_BATCH_WRITE_SEGMENTS;
+			uint32_t op_len = op.len + (op.is_read ? 5 : 3);			// RESTART + address + register (+ RESTART + address)
+			if (segments + op_segments > I2C_MAX_SEGMENTS || seq_len + op_len > I2C_MAX_SEQUENCE_LEN) break;
+
+			if (segments) sequence[seq_len++] = I2C_RESTART;
+			sequence[seq_len++] = I2CAddr_Write;
+			sequence[seq_len++] = op.reg;
+
+			if (op.is_read) {
+				if (!data_received) data_received = &batch->received[op.offset];	// reads are stored back-to-back
+				sequence[seq_len++] = I2C_RESTART;
+				sequence[seq_len++] = I2CAddr_Read;
+				for (int j = 0; j < op.len; j++) sequence[seq_len++] = I2C_READ;
+			} else {
+				for (int j = 0; j < op.len; j++) sequence[seq_len++] = batch->written[op.offset + j];
+			}
+			segments += op_segments;
+			bytes += op.len;
+		}
+
+		I2C_PROFILE_TIMER(timer);
+		if (session.transfer(sequence, seq_len, data_received, batch->retry) < 0) status = -1;
+		I2C_PROFILE_RECORD(timer, sequence[1], I2C_OP_BATCH, bytes);
+	}
+
+	return status;
+}
+
+template <class Bus>
+void I2C_Functions<Bus>::idle(uint32_t us) {
+	session.idle((uint64_t)us * 1000);
+}
+
+template <class Bus>
+const i2c_stats_t& I2C_Functions<Bus>::get_stats() {
+	return session.getStats();
+}
+
+template <class Bus>
+void I2C_Functions<Bus>::print_stats() {
+	session.printStats();
+	arbiter.printStats();
+}
+
 /********************* Visualize *******************/
 
-void I2C_Functions::print_uint8(std::string descriptor, uint8_t data) {
+template <class Bus>
+void I2C_Functions<Bus>::print_uint8(std::string descriptor, uint8_t data) {
 	std::cout << descriptor << ": " << std::hex << static_cast<int>(data) << std::endl;
 }
 
-void I2C_Functions::print_uint16(std::string descriptor, uint16_t data) {
+template <class Bus>
+void I2C_Functions<Bus>::print_uint16(std::string descriptor, uint16_t data) {
 	std::cout << descriptor << ": " << std::hex << static_cast<int>(data) << std::endl;
-}
\ No newline at end of file
+}
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class I2C_Functions<I2C_Bus>;
@@ -25,6 +25,11 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include "lsquaredc.h"
+#include "I2C_Policy.h"
+#include "I2C_Batch.h"
+#include "I2C_Profiler.h"
+#include "I2C_Arbiter.h"
+#include "Log.h"
 
 
 /*************************** Defines ***************************/
@@ -37,13 +42,20 @@
 #define C_BIG_ENDIAN		0
 #define C_LITTLE_ENDIAN		1
 
+#define I2C_MAX_TRANSFER_LEN	(I2C_MAX_SEQUENCE_LEN - 4)		// most bytes moved by a single writen()/readn()
+
 
 /************************** Functions **************************/
 
+/* Bus is the transport policy (see I2C_Policy.h). */
+template <class Bus>
 class I2C_Functions {
 private:
 	uint8_t I2CBus, I2CAddr_Write, I2CAddr_Read;
 	bool endianness;
+	Bus session;
+	uint16_t sequence[I2C_MAX_SEQUENCE_LEN];					// sequence storage reused by every batch
+	I2C_Arbiter& arbiter;										// serializes every device and thread on the bus, by priority
 
 public:  
 	I2C_Functions();
@@ -53,10 +65,15 @@ public:
 
 	int write(uint8_t reg, uint8_t data);						// writes 1 byte of data into register
 	int write2(uint8_t reg, uint16_t data);						// writes 2 bytes of data into consecutive registers
-	int writen(uint8_t reg, uint8_t* data, int n);				// wrotes n bytes of data into conecutive register
+	int writen(uint8_t reg, const uint8_t* data, int n, bool retry = true);	// wrotes n bytes of data into conecutive register (n <= I2C_MAX_TRANSFER_LEN, no retry for FIFOs)
 	uint8_t read(uint8_t reg);									// reads 1 byte of data from register
 	uint16_t read2(uint8_t reg);								// reads 2 bytes of data from consecutive registers
-	uint8_t* readn(uint8_t reg, int n, uint8_t* data_received);	// reads n bytes of data from consecutive registers (requires memory preallocation)
+	uint8_t* readn(uint8_t reg, int n, uint8_t* data_received, bool retry = true);	// reads n bytes of data from consecutive registers (requires memory preallocation, n <= I2C_MAX_TRANSFER_LEN, returns 0 on failure)
+	int execute(I2C_Batch* batch);								// sends every queued operation of the batch in as few transactions as possible
+	void idle(uint32_t us);										// waits without holding the bus (a simulated bus advances its clock instead)
+
+	const i2c_stats_t& get_stats();								// fetches the bus statistics of the session
+	void print_stats();											// prints the bus and arbitration statistics
 	
 	void print_uint8(std::string descriptor, uint8_t data);
 	void print_uint16(std::string descriptor, uint16_t data);
@@ -0,0 +1,56 @@
+/****************************************************************************
+* I2C_Policy.h
+*
+* @about      : selects the bus policy the radio stack is compiled against.
+*               A policy is any class with the I2C_Session interface:
+*                 explicit Policy(uint8_t bus);
+*                 int transfer(uint16_t* sequence, uint32_t len, uint8_t* rx, bool retry = true);
+*                 int writeBlock(uint8_t addr, uint8_t reg, const uint8_t* data, uint32_t n, bool retry = true);
+*                 int readBlock(uint8_t addr, uint8_t reg, uint8_t* data, uint32_t n, bool retry = true);
+*                 void idle(uint64_t ns);
+*                 bool isOpen() const;
+*                 const i2c_stats_t& getStats() const;
+*                 void resetStats();
+*                 void printStats();
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_POLICY
+#define I2C_POLICY
+
+
+/************************** Includes **************************/
+
+#include "I2C_Session.h"
+#ifdef URTX_SIMULATION
+#include "URTX_Simulator.h"
+#endif
+#if defined(I2C_RECORD_BUILD) || defined(I2C_REPLAY_BUILD)
+#include "I2C_Record.h"
+#endif
+
+
+/*************************** Policy ***************************/
+
+/* flight: /dev/i2c-N, bench: the simulated transceiver */
+#if defined(URTX_SIMULATION)
+typedef Sim_Session I2C_Transport;
+#else
+typedef I2C_Session I2C_Transport;
+#endif
+
+/* record: the transport above, logged to i2c-N.rec; replay: the log played back (see I2C_Record.h) */
+#if defined(I2C_RECORD_BUILD)
+typedef I2C_Recorder<I2C_Transport> I2C_Bus;
+#elif defined(I2C_REPLAY_BUILD)
+typedef I2C_Replay I2C_Bus;
+#else
+typedef I2C_Transport I2C_Bus;
+#endif
+
+#endif // I2C_POLICY
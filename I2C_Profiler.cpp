@@ -0,0 +1,175 @@
+ /****************************************************************************
+ * I2C_Profiler.cpp
+ *
+ * @about      : per-register I2C transaction profiler. Compiled in only when
+ *               I2C_PROFILE is defined (make PROFILE=1); otherwise every
+ *               macro below expands to nothing. The profile is printed on
+ *               SIGUSR1 and at exit.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include "I2C_Profiler.h"
+
+#ifdef I2C_PROFILE
+
+#include <time.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#define MAX_CALLERS		128
+
+struct profile_entry_t {
+	const char* caller;
+	uint8_t reg;
+	uint8_t op;
+	bool used;
+	uint64_t count;
+	uint64_t bytes;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t histogram[I2C_PROFILE_BUCKETS];
+};
+
+static profile_entry_t entries[I2C_PROFILE_MAX_ENTRIES];
+static uint64_t num_scans = 0;
+static uint64_t num_dropped = 0;								// records lost because the table was full
+static thread_local const char* current_caller = 0;
+static volatile sig_atomic_t dump_requested = 0;
+
+static const char* op_names[I2C_NUM_OPS] = {"read", "write", "batch"};
+
+static uint64_t monotonic_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int bucket(uint64_t ns) {
+	uint64_t us = ns / 1000;
+	int b = 0;
+	while (us && b < I2C_PROFILE_BUCKETS - 1) {
+		us >>= 1;
+		b++;
+	}
+	return b;
+}
+
+static profile_entry_t* lookup(const char* caller, uint8_t reg, int op) {
+	uint32_t hash = (uint32_t)(((uintptr_t)caller >> 3) * 31 + reg * 7 + op) % I2C_PROFILE_MAX_ENTRIES;
+
+	for (int i = 0; i < I2C_PROFILE_MAX_ENTRIES; i++) {
+		profile_entry_t* entry = &entries[(hash + i) % I2C_PROFILE_MAX_ENTRIES];
+		if (!entry->used) {
+			entry->used = true;
+			entry->caller = caller;
+			entry->reg = reg;
+			entry->op = op;
+			return entry;
+		}
+		if (entry->caller == caller && entry->reg == reg && entry->op == op) return entry;
+	}
+	return 0;
+}
+
+static void request_dump(int) {
+	dump_requested = 1;											// printed from the next record, outside of the handler
+}
+
+/* installs the dump hooks before main() runs */
+static struct profile_hooks_t {
+	profile_hooks_t() {
+		signal(SIGUSR1, request_dump);
+		atexit(i2c_profile_dump);
+	}
+} profile_hooks;
+
+
+/************************ Profiler ****************************/
+
+I2C_ProfileTimer::I2C_ProfileTimer() {
+	start_ns = monotonic_ns();
+}
+
+void I2C_ProfileTimer::record(uint8_t reg, int op, int bytes) {
+	uint64_t ns = monotonic_ns() - start_ns;
+	const char* caller = current_caller ? current_caller : "(direct)";
+
+	profile_entry_t* entry = lookup(caller, reg, op);
+	if (!entry) {
+		num_dropped++;
+	} else {
+		entry->count++;
+		entry->bytes += bytes;
+		entry->total_ns += ns;
+		if (ns > entry->max_ns) entry->max_ns = ns;
+		entry->histogram[bucket(ns)]++;
+	}
+
+	if (dump_requested) {
+		dump_requested = 0;
+		i2c_profile_dump();
+	}
+}
+
+I2C_ProfileScope::I2C_ProfileScope(const char* caller) {
+	owner = (current_caller == 0);
+	if (owner) current_caller = caller;
+}
+
+I2C_ProfileScope::~I2C_ProfileScope() {
+	if (owner) current_caller = 0;
+}
+
+void i2c_profile_tick() {
+	num_scans++;
+}
+
+void i2c_profile_dump() {
+	struct caller_total_t {
+		const char* caller;
+		uint64_t count, bytes, total_ns;
+	} callers[MAX_CALLERS];
+	int num_callers = 0;
+	double scans = num_scans ? (double)num_scans : 1.0;
+
+	printf("\n==================== I2C Profile (%llu scans) ====================\n", (unsigned long long)num_scans);
+	printf("%-24s %4s %-5s %10s %8s %10s %9s %9s   histogram (us: <1 <2 <4 ...)\n",
+		   "caller", "reg", "op", "count", "/scan", "bytes", "avg us", "max us");
+
+	for (int i = 0; i < I2C_PROFILE_MAX_ENTRIES; i++) {
+		const profile_entry_t& e = entries[i];
+		if (!e.used) continue;
+
+		printf("%-24s 0x%02X %-5s %10llu %8.1f %10llu %9.1f %9.1f  ", e.caller, e.reg, op_names[e.op],
+			   (unsigned long long)e.count, e.count / scans, (unsigned long long)e.bytes,
+			   e.total_ns / 1000.0 / e.count, e.max_ns / 1000.0);
+		for (int b = 0; b < I2C_PROFILE_BUCKETS; b++) printf(" %llu", (unsigned long long)e.histogram[b]);
+		printf("\n");
+
+		int c = 0;
+		while (c < num_callers && callers[c].caller != e.caller) c++;
+		if (c == num_callers) {
+			if (num_callers == MAX_CALLERS) continue;
+			callers[num_callers++] = {e.caller, 0, 0, 0};
+		}
+		callers[c].count += e.count;
+		callers[c].bytes += e.bytes;
+		callers[c].total_ns += e.total_ns;
+	}
+
+	printf("\n%-24s %10s %8s %10s %12s\n", "caller", "count", "/scan", "bytes", "total us");
+	for (int c = 0; c < num_callers; c++) {
+		printf("%-24s %10llu %8.1f %10llu %12.1f\n", callers[c].caller, (unsigned long long)callers[c].count,
+			   callers[c].count / scans, (unsigned long long)callers[c].bytes, callers[c].total_ns / 1000.0);
+	}
+	if (num_dropped) printf("(%llu records dropped, profile table full)\n", (unsigned long long)num_dropped);
+	fflush(stdout);
+}
+
+#endif // I2C_PROFILE
@@ -0,0 +1,75 @@
+/****************************************************************************
+* I2C_Profiler.h
+*
+* @about      : per-register I2C transaction profiler. Compiled in only when
+*               I2C_PROFILE is defined (make PROFILE=1); otherwise every
+*               macro below expands to nothing. The profile is printed on
+*               SIGUSR1 and at exit.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_PROFILER
+#define I2C_PROFILER
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+
+
+/*************************** Defines ***************************/
+
+#define I2C_OP_READ					0
+#define I2C_OP_WRITE				1
+#define I2C_OP_BATCH				2
+#define I2C_NUM_OPS					3
+
+#define I2C_PROFILE_MAX_ENTRIES		512		// distinct (caller, register, operation) triplets
+#define I2C_PROFILE_BUCKETS			16		// latency histogram buckets: [0, 1), [1, 2), [2, 4) ... us
+
+
+#ifdef I2C_PROFILE
+
+/* Times one bus operation from construction to record(). */
+class I2C_ProfileTimer {
+private:
+	uint64_t start_ns;
+
+public:
+	I2C_ProfileTimer();
+	void record(uint8_t reg, int op, int bytes);				// adds the elapsed time to the profile
+};
+
+/* Attributes every transaction issued during its lifetime to 'caller' (the outermost scope wins). */
+class I2C_ProfileScope {
+private:
+	bool owner;
+
+public:
+	explicit I2C_ProfileScope(const char* caller);
+	~I2C_ProfileScope();
+};
+
+void i2c_profile_tick();										// counts one radio scan
+void i2c_profile_dump();										// prints the profile
+
+#define I2C_PROFILE_TIMER(name)				I2C_ProfileTimer name
+#define I2C_PROFILE_RECORD(name, reg, op, bytes)	name.record(reg, op, bytes)
+#define I2C_PROFILE_SCOPE()					I2C_ProfileScope i2c_profile_scope(__func__)
+#define I2C_PROFILE_TICK()					i2c_profile_tick()
+
+#else
+
+#define I2C_PROFILE_TIMER(name)
+#define I2C_PROFILE_RECORD(name, reg, op, bytes)	((void)(bytes))
+#define I2C_PROFILE_SCOPE()
+#define I2C_PROFILE_TICK()
+
+#endif // I2C_PROFILE
+
+#endif // I2C_PROFILER
@@ -0,0 +1,121 @@
+ /****************************************************************************
+ * I2C_Record.cpp
+ *
+ * @about      : bus policies that record every transaction of another policy
+ *               to a file, and that replay such a recording in place of the
+ *               hardware.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <string.h>
+#include "I2C_Record.h"
+
+uint32_t i2c_sequence_reads(const uint16_t* sequence, uint32_t sequence_length) {
+	uint32_t reads = 0;
+	for (uint32_t i = 0; i < sequence_length; i++) {
+		if (sequence[i] == I2C_READ) reads++;
+	}
+	return reads;
+}
+
+FILE* i2c_record_open(uint8_t bus, const char* mode) {
+	char filename[I2C_RECORD_NAME_LEN];
+	snprintf(filename, I2C_RECORD_NAME_LEN, I2C_RECORD_FILE, bus);
+
+	FILE* log = fopen(filename, mode);
+	if (!log) std::cout << "ERROR: Unable to open the bus recording " << filename << "." << std::endl;
+	return log;
+}
+
+I2C_Replay::I2C_Replay(uint8_t bus) {
+	this->bus = bus;
+	log = i2c_record_open(bus, "rb");
+	resetStats();
+}
+
+I2C_Replay::~I2C_Replay() {
+	if (log) fclose(log);
+}
+
+int I2C_Replay::next(uint8_t op, uint8_t address, uint8_t reg, const void* sent, uint32_t sent_len,
+					 uint8_t* received, uint32_t received_len) {
+	i2c_record_t header;
+	uint8_t recorded[I2C_MAX_SEQUENCE_LEN * sizeof(uint16_t)];
+
+	if (!log || fread(&header, sizeof(header), 1, log) != 1) {
+		std::cout << "ERROR: The bus recording has ended." << std::endl;
+		stats.failures++;
+		return -1;
+	}
+
+	bool diverged = header.op != op || header.address != address || header.reg != reg ||
+					header.sent != sent_len || header.received != received_len ||
+					header.sent > sizeof(recorded) || header.received > sizeof(recorded);
+
+	/* the payload is always consumed, so the replay stays aligned with the recording after a divergence */
+	if (header.sent <= sizeof(recorded)) {
+		if (fread(recorded, 1, header.sent, log) != header.sent) diverged = true;
+		else if (!diverged && sent_len && memcmp(recorded, sent, sent_len)) diverged = true;
+	} else {
+		fseek(log, header.sent, SEEK_CUR);
+	}
+
+	if (header.received <= sizeof(recorded)) {
+		if (fread(recorded, 1, header.received, log) != header.received) diverged = true;
+		else if (!diverged && received) memcpy(received, recorded, received_len);
+	} else {
+		fseek(log, header.received, SEEK_CUR);
+	}
+
+	if (diverged) {
+		divergences++;
+		stats.failures++;
+		return -1;
+	}
+	if (header.status < 0) stats.failures++;
+	else 				   stats.transactions++;
+
+	return header.status;
+}
+
+int I2C_Replay::transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool) {
+	return next(I2C_RECORD_SEQUENCE, 0, 0, sequence, sequence_length * sizeof(uint16_t),
+				received_data, received_data ? i2c_sequence_reads(sequence, sequence_length) : 0);
+}
+
+int I2C_Replay::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool) {
+	return next(I2C_RECORD_WRITE, address, reg, data, n, 0, 0);
+}
+
+int I2C_Replay::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool) {
+	return next(I2C_RECORD_READ, address, reg, 0, 0, data, n);
+}
+
+void I2C_Replay::idle(uint64_t ns) {
+	/* the recording already holds whatever the device reported after the wait */
+}
+
+bool I2C_Replay::isOpen() const {
+	return log != 0;
+}
+
+const i2c_stats_t& I2C_Replay::getStats() const {
+	return stats;
+}
+
+void I2C_Replay::resetStats() {
+	stats = {0, 0, 0, 0, 0, 0, 0, 0};
+	divergences = 0;
+}
+
+void I2C_Replay::printStats() {
+	std::cout << std::dec;
+	std::cout << "I2C Bus " << static_cast<int>(bus) << " Statistics (replayed):" << std::endl;
+	std::cout << "\tTransactions: " << stats.transactions << ", Failures: " << stats.failures << std::endl;
+	std::cout << "\tDivergences: " << divergences << std::endl;
+}
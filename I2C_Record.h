@@ -0,0 +1,138 @@
+/****************************************************************************
+* I2C_Record.h
+*
+* @about      : bus policies that record every transaction of another policy
+*               to a file, and that replay such a recording in place of the
+*               hardware.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_RECORD
+#define I2C_RECORD
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <iostream>
+#include "I2C_Session.h"
+
+
+/*************************** Defines ***************************/
+
+#define I2C_RECORD_FILE			"i2c-%d.rec"	// one recording per bus
+#define I2C_RECORD_NAME_LEN		32
+
+#define I2C_RECORD_SEQUENCE		0		// transfer(): lsquaredc sequence
+#define I2C_RECORD_WRITE		1		// writeBlock()
+#define I2C_RECORD_READ			2		// readBlock()
+
+
+/* every transaction is stored as this header, the bytes sent and the bytes received */
+struct i2c_record_t {
+	uint8_t op;							// I2C_RECORD_SEQUENCE, I2C_RECORD_WRITE or I2C_RECORD_READ
+	uint8_t address;					// 7-bit address (0 for sequences, which carry their own)
+	uint8_t reg;						// first register (0 for sequences)
+	int8_t status;						// result of the transaction
+	uint32_t sent;						// payload bytes sent (2 per sequence element)
+	uint32_t received;					// payload bytes received
+};
+
+uint32_t i2c_sequence_reads(const uint16_t* sequence, uint32_t sequence_length);	// bytes a sequence reads back
+FILE* i2c_record_open(uint8_t bus, const char* mode);								// opens the recording of a bus
+
+
+/************************** Recorder **************************/
+
+/* Forwards every transaction to the Bus policy and appends it to i2c-N.rec. */
+template <class Bus>
+class I2C_Recorder {
+private:
+	Bus bus;
+	FILE* log;
+
+	void record(uint8_t op, uint8_t address, uint8_t reg, int status, const void* sent, uint32_t sent_len,
+				const uint8_t* received, uint32_t received_len) {
+		if (!log) return;
+		i2c_record_t header = {op, address, reg, (int8_t)(status < 0 ? -1 : 0), sent_len, received_len};
+		fwrite(&header, sizeof(header), 1, log);
+		if (sent_len) fwrite(sent, 1, sent_len, log);
+		if (received_len) fwrite(received, 1, received_len, log);
+	}
+
+public:
+	explicit I2C_Recorder(uint8_t bus = 0) : bus(bus) {
+		log = i2c_record_open(bus, "wb");
+	}
+	I2C_Recorder(const I2C_Recorder&) = delete;
+	I2C_Recorder& operator=(const I2C_Recorder&) = delete;
+	~I2C_Recorder() {
+		if (log) fclose(log);
+	}
+
+	int transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool retry = true) {
+		int status = bus.transfer(sequence, sequence_length, received_data, retry);
+		record(I2C_RECORD_SEQUENCE, 0, 0, status, sequence, sequence_length * sizeof(uint16_t),
+			   received_data, received_data ? i2c_sequence_reads(sequence, sequence_length) : 0);
+		return status;
+	}
+
+	int writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool retry = true) {
+		int status = bus.writeBlock(address, reg, data, n, retry);
+		record(I2C_RECORD_WRITE, address, reg, status, data, n, 0, 0);
+		return status;
+	}
+
+	int readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool retry = true) {
+		int status = bus.readBlock(address, reg, data, n, retry);
+		record(I2C_RECORD_READ, address, reg, status, 0, 0, data, n);
+		return status;
+	}
+
+	void idle(uint64_t ns) { bus.idle(ns); }
+	bool isOpen() const { return bus.isOpen(); }
+	const i2c_stats_t& getStats() const { return bus.getStats(); }
+	void resetStats() { bus.resetStats(); }
+	void printStats() {
+		bus.printStats();
+		std::cout << "\tRecording: " << (log ? "on" : "off") << std::endl;
+	}
+};
+
+
+/*************************** Replay ***************************/
+
+/* Serves every transaction from a recording made by I2C_Recorder, without touching the hardware. */
+class I2C_Replay {
+private:
+	uint8_t bus;
+	FILE* log;
+	i2c_stats_t stats;
+	uint32_t divergences;				// transactions that differ from the recording
+
+	int next(uint8_t op, uint8_t address, uint8_t reg, const void* sent, uint32_t sent_len,
+			 uint8_t* received, uint32_t received_len);	// consumes the next recorded transaction
+
+public:
+	explicit I2C_Replay(uint8_t bus = 0);
+	I2C_Replay(const I2C_Replay&) = delete;
+	I2C_Replay& operator=(const I2C_Replay&) = delete;
+	~I2C_Replay();
+
+	int transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool retry = true);
+	int writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool retry = true);
+	int readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool retry = true);
+	void idle(uint64_t ns);
+	bool isOpen() const;
+	const i2c_stats_t& getStats() const;
+	void resetStats();
+	void printStats();
+};
+
+#endif // I2C_RECORD
@@ -0,0 +1,221 @@
+ /****************************************************************************
+ * I2C_Session.cpp
+ *
+ * @about      : owns a single /dev/i2c-N handle for the lifetime of a device.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include "I2C_Session.h"
+#include <time.h>
+
+I2C_Session::I2C_Session(uint8_t bus) {
+	this->bus = bus;
+	handle = -1;
+	funcs = 0;
+	funcs_reported = false;
+	slave = I2C_NO_SLAVE;
+	resetStats();
+}
+
+I2C_Session::~I2C_Session() {
+	close();
+}
+
+int I2C_Session::open() {
+	if (handle >= 0) return handle;
+
+	handle = i2c_open_funcs(bus, &funcs);
+	stats.opens++;
+	stats.syscalls += I2C_SYSCALLS_OPEN;
+	reportFuncs();
+
+	if (handle < 0) {
+		std::cout << "ERROR: Unable to open /dev/i2c-" << static_cast<int>(bus) << "." << std::endl;
+	}
+	return handle;
+}
+
+void I2C_Session::reportFuncs() {
+	/* a transfer the adapter cannot issue fails without reaching the bus, so the gaps are logged once, when probed */
+	if (funcs_reported || !funcs) return;
+	funcs_reported = true;
+
+	if (funcs & I2C_FUNC_I2C) return;
+	if (!(funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK)) {
+		std::cout << "ERROR: /dev/i2c-" << static_cast<int>(bus) << " supports neither I2C_FUNC_I2C nor SMBus I2C-block writes." << std::endl;
+	}
+	if (!(funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK)) {
+		std::cout << "ERROR: /dev/i2c-" << static_cast<int>(bus) << " supports neither I2C_FUNC_I2C nor SMBus I2C-block reads." << std::endl;
+	}
+	if (funcs & I2C_FUNC_SMBUS_I2C_BLOCK) {
+		std::cout << "WARNING: /dev/i2c-" << static_cast<int>(bus) << " has no I2C_FUNC_I2C, blocks over "
+		          << I2C_SMBUS_BLOCK_MAX << " bytes will fail." << std::endl;
+	}
+}
+
+void I2C_Session::close() {
+	if (handle < 0) return;
+
+	i2c_close(handle);
+	stats.syscalls += I2C_SYSCALLS_CLOSE;
+	handle = -1;
+	slave = I2C_NO_SLAVE;
+}
+
+int I2C_Session::reconnect() {
+	close();
+	stats.reconnects++;
+	return open();
+}
+
+int I2C_Session::selectSlave(uint8_t address) {
+	if (slave == address) return 0;
+
+	stats.syscalls += I2C_SYSCALLS_SLAVE;
+	if (i2c_set_slave(handle, address) < 0) return -1;
+	slave = address;
+	return 0;
+}
+
+int I2C_Session::writeBlockOnce(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n) {
+	int status = -1;
+
+	if (n <= I2C_SMBUS_BLOCK_MAX && (funcs & I2C_FUNC_SMBUS_WRITE_I2C_BLOCK)) {
+		if (selectSlave(address) < 0) return -1;
+		status = i2c_smbus_write_block(handle, reg, data, n);
+		stats.smbus_blocks++;
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	} else if (funcs & I2C_FUNC_I2C) {
+		/* the register pointer and the data must go out as one message, so it is staged in the arena */
+		if (selectSlave(address) < 0) return -1;
+		status = i2c_write_raw(handle, reg, data, n, arena.msg_buf);
+		stats.raw_writes++;
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	}
+	return status;
+}
+
+int I2C_Session::readBlockOnce(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n) {
+	int status = -1;
+
+	if (n <= I2C_SMBUS_BLOCK_MAX && (funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK)) {
+		if (selectSlave(address) < 0) return -1;
+		status = i2c_smbus_read_block(handle, reg, data, n);
+		stats.smbus_blocks++;
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	} else if (funcs & I2C_FUNC_I2C) {
+		/* a plain write()/read() pair would release the bus in between, so reads always use a repeated start */
+		status = i2c_write_read(handle, address, reg, data, n);
+		stats.direct_rdwr++;
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	}
+	return status;
+}
+
+int I2C_Session::recover(int status, bool retry) {
+	if (status < 0 && !retry) reconnect();						// the next transfer starts on a fresh handle, this one is reported as failed
+	return status;
+}
+
+int I2C_Session::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool retry) {
+	int status = -1;
+
+	if (n + 1 > I2C_MAX_SEQUENCE_LEN) {
+		std::cout << "ERROR: I2C block of " << std::dec << n << " bytes exceeds " << I2C_MAX_SEQUENCE_LEN - 1 << " bytes." << std::endl;
+		stats.failures++;
+		return -1;
+	}
+
+	if (open() >= 0) status = recover(writeBlockOnce(address, reg, data, n), retry);
+	for (int i = 0; status < 0 && retry && i < I2C_SESSION_RETRIES; i++) {
+		if (reconnect() < 0) continue;
+		status = writeBlockOnce(address, reg, data, n);
+	}
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+int I2C_Session::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool retry) {
+	int status = -1;
+
+	if (n > I2C_MAX_SEQUENCE_LEN) {
+		std::cout << "ERROR: I2C block of " << std::dec << n << " bytes exceeds " << I2C_MAX_SEQUENCE_LEN << " bytes." << std::endl;
+		stats.failures++;
+		return -1;
+	}
+
+	if (open() >= 0) status = recover(readBlockOnce(address, reg, data, n), retry);
+	for (int i = 0; status < 0 && retry && i < I2C_SESSION_RETRIES; i++) {
+		if (reconnect() < 0) continue;
+		status = readBlockOnce(address, reg, data, n);
+	}
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+int I2C_Session::transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool retry) {
+	int status = -1;
+
+	if (sequence_length > I2C_MAX_SEQUENCE_LEN) {
+		std::cout << "ERROR: I2C sequence of " << std::dec << sequence_length << " exceeds " << I2C_MAX_SEQUENCE_LEN << " elements." << std::endl;
+		stats.failures++;
+		return -1;
+	}
+
+	if (open() >= 0) {
+		status = recover(i2c_send_sequence_arena(handle, sequence, sequence_length, received_data, &arena), retry);
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	}
+
+	/* the adapter may have been reset underneath us (e.g. after a bus lockup), so retry on a fresh handle */
+	for (int i = 0; status < 0 && retry && i < I2C_SESSION_RETRIES; i++) {
+		if (reconnect() < 0) continue;
+		status = i2c_send_sequence_arena(handle, sequence, sequence_length, received_data, &arena);
+		stats.syscalls += I2C_SYSCALLS_TRANSFER;
+	}
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+void I2C_Session::idle(uint64_t ns) {
+	struct timespec ts = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+	nanosleep(&ts, NULL);
+}
+
+bool I2C_Session::isOpen() const {
+	return handle >= 0;
+}
+
+const i2c_stats_t& I2C_Session::getStats() const {
+	return stats;
+}
+
+void I2C_Session::resetStats() {
+	stats = {0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+void I2C_Session::printStats() {
+	/* without a persistent session, every transaction costs an open, a probe, the transfer and a close */
+	uint32_t legacy_syscalls = (stats.transactions + stats.failures) * (I2C_SYSCALLS_OPEN + I2C_SYSCALLS_TRANSFER + I2C_SYSCALLS_CLOSE);
+
+	std::cout << std::dec;
+	std::cout << "I2C Bus " << static_cast<int>(bus) << " Statistics:" << std::endl;
+	std::cout << "\tTransactions: " << stats.transactions << ", Failures: " << stats.failures << std::endl;
+	std::cout << "\tOpens: " << stats.opens << ", Reconnects: " << stats.reconnects << std::endl;
+	std::cout << "\tSMBus Blocks: " << stats.smbus_blocks << ", Raw Writes: " << stats.raw_writes << ", Direct RDWR: " << stats.direct_rdwr << std::endl;
+	std::cout << "\tSyscalls: " << stats.syscalls << " (open/close per transaction: " << legacy_syscalls << ")" << std::endl;
+}
@@ -0,0 +1,88 @@
+/****************************************************************************
+* I2C_Session.h
+*
+* @about      : owns a single /dev/i2c-N handle for the lifetime of a device.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_SESSION
+#define I2C_SESSION
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <iostream>
+#include "lsquaredc.h"
+
+
+/*************************** Defines ***************************/
+
+#define I2C_SESSION_RETRIES		1		// number of reconnect attempts after a failed transaction (when it may be replayed)
+
+/* syscalls issued by each lsquaredc call (used for the bus statistics) */
+#define I2C_SYSCALLS_OPEN		2		// open() + ioctl(I2C_FUNCS)
+#define I2C_SYSCALLS_TRANSFER	1		// ioctl(I2C_RDWR), ioctl(I2C_SMBUS) or write()
+#define I2C_SYSCALLS_SLAVE		1		// ioctl(I2C_SLAVE)
+#define I2C_SYSCALLS_CLOSE		1		// close()
+
+#define I2C_NO_SLAVE			0xFF	// no slave address selected on the handle
+
+
+struct i2c_stats_t {
+	uint32_t transactions;				// successful transfers
+	uint32_t failures;					// transfers that failed even after reconnecting
+	uint32_t opens;						// number of times the device was opened
+	uint32_t reconnects;				// number of times the device was reopened after an error
+	uint32_t syscalls;					// total number of syscalls issued on the bus
+	uint32_t smbus_blocks;				// block transfers sent as SMBus I2C-block transactions
+	uint32_t raw_writes;				// block writes sent with a plain write()
+	uint32_t direct_rdwr;				// block reads sent as a two-message I2C_RDWR
+};
+
+
+/*************************** Session ***************************/
+
+class I2C_Session {
+private:
+	uint8_t bus;
+	int handle;
+	unsigned long funcs;										// I2C_FUNCS mask of the adapter, probed at open
+	bool funcs_reported;										// its missing capabilities were logged
+	uint8_t slave;												// address currently selected with I2C_SLAVE
+	i2c_stats_t stats;
+	struct i2c_arena arena;										// message storage reused by every transfer
+
+	int open();													// opens and probes the bus, if not already open
+	void close();												// closes the bus, if open
+	int reconnect();											// closes and reopens the bus after an error
+	void reportFuncs();											// logs the transfers the adapter cannot issue (once)
+	int recover(int status, bool retry);						// reconnects after a failure that may not be replayed
+	int selectSlave(uint8_t address);							// points the read()/write()/SMBus paths at a device
+	int writeBlockOnce(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n);
+	int readBlockOnce(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n);
+
+public:
+	explicit I2C_Session(uint8_t bus = 0);
+	I2C_Session(const I2C_Session&) = delete;
+	I2C_Session& operator=(const I2C_Session&) = delete;
+	~I2C_Session();
+
+	/* 'retry' replays a failed transfer on a fresh handle; FIFO transfers clear it, since a failed one may have
+	   partly completed (a replay would duplicate TX bytes or lose RX bytes), and the caller decides instead */
+	int transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool retry = true);	// sends an lsquaredc sequence (at most I2C_MAX_SEQUENCE_LEN long)
+	int writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool retry = true);	// writes consecutive registers over the cheapest supported path
+	int readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool retry = true);			// reads consecutive registers over the cheapest supported path
+	void idle(uint64_t ns);										// waits without touching the bus
+	bool isOpen() const;										// determines whether the handle is currently open
+	const i2c_stats_t& getStats() const;						// fetches the bus statistics
+	void resetStats();											// clears the bus statistics
+	void printStats();											// prints the bus statistics
+};
+
+#endif // I2C_SESSION
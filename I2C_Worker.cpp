@@ -0,0 +1,129 @@
+ /****************************************************************************
+ * I2C_Worker.cpp
+ *
+ * @about      : a dedicated thread that owns the bus and executes queued
+ *               transactions in order. Requests are passed through a
+ *               bounded lock-free queue and completed through futures or
+ *               callbacks.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include "I2C_Worker.h"
+
+I2C_Worker::I2C_Worker() {
+	for (size_t i = 0; i < I2C_WORKER_QUEUE_LEN; i++) {
+		queue[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	enqueue_pos.store(0, std::memory_order_relaxed);
+	dequeue_pos.store(0, std::memory_order_relaxed);
+
+	sleeping = false;
+	running = true;
+	thread = std::thread(&I2C_Worker::run, this);
+}
+
+I2C_Worker::~I2C_Worker() {
+	/* the worker drains whatever is still queued before it exits */
+	running = false;
+	{
+		std::lock_guard<std::mutex> lock(sleep_lock);
+	}
+	wakeup.notify_one();
+	thread.join();
+}
+
+bool I2C_Worker::push(std::function<void()>& task) {
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell_t* cell = &queue[pos & (I2C_WORKER_QUEUE_LEN - 1)];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) {
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				cell->task = std::move(task);
+				cell->sequence.store(pos + 1, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false;											// full
+		} else {
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+bool I2C_Worker::pop(std::function<void()>& task) {
+	size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell_t* cell = &queue[pos & (I2C_WORKER_QUEUE_LEN - 1)];
+		size_t seq = cell->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+		if (diff == 0) {
+			if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+				task = std::move(cell->task);
+				cell->sequence.store(pos + I2C_WORKER_QUEUE_LEN, std::memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			return false;											// empty
+		} else {
+			pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void I2C_Worker::post(std::function<void()> task) {
+	if (onWorkerThread()) {
+		task();														// a request issued by a request would deadlock waiting for itself
+		return;
+	}
+
+	while (!push(task)) std::this_thread::yield();
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);			// pairs with the fence in run()
+	if (sleeping) {
+		{
+			std::lock_guard<std::mutex> lock(sleep_lock);
+		}
+		wakeup.notify_one();
+	}
+}
+
+bool I2C_Worker::onWorkerThread() const {
+	return std::this_thread::get_id() == thread.get_id();
+}
+
+void I2C_Worker::run() {
+	std::function<void()> task;
+
+	while (true) {
+		if (pop(task)) {
+			task();
+			task = nullptr;
+			continue;
+		}
+		if (!running) break;
+
+		/* nothing queued: park until a producer wakes us (the flag is re-checked against the queue under the lock) */
+		std::unique_lock<std::mutex> lock(sleep_lock);
+		sleeping = true;
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		while (running && !pop(task)) wakeup.wait(lock);
+		sleeping = false;
+		lock.unlock();
+
+		if (task) {
+			task();
+			task = nullptr;
+		}
+	}
+}
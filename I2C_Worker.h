@@ -0,0 +1,78 @@
+/****************************************************************************
+* I2C_Worker.h
+*
+* @about      : a dedicated thread that owns the bus and executes queued
+*               transactions in order. Requests are passed through a
+*               bounded lock-free queue and completed through futures or
+*               callbacks.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef I2C_WORKER
+#define I2C_WORKER
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+
+/*************************** Defines ***************************/
+
+#define I2C_WORKER_QUEUE_LEN	64		// pending requests (must be a power of two)
+
+
+/*************************** Worker ***************************/
+
+class I2C_Worker {
+private:
+	/* bounded multi-producer queue (D. Vyukov): each cell's sequence number says whose turn it is */
+	struct cell_t {
+		std::atomic<size_t> sequence;
+		std::function<void()> task;
+	};
+
+	cell_t queue[I2C_WORKER_QUEUE_LEN];
+	std::atomic<size_t> enqueue_pos, dequeue_pos;
+
+	std::thread thread;
+	std::atomic<bool> running;
+	std::atomic<bool> sleeping;
+	std::mutex sleep_lock;											// only used to park the idle worker
+	std::condition_variable wakeup;
+
+	bool push(std::function<void()>& task);							// false if the queue is full
+	bool pop(std::function<void()>& task);							// false if the queue is empty
+	void run();
+
+public:
+	I2C_Worker();
+	I2C_Worker(const I2C_Worker&) = delete;
+	I2C_Worker& operator=(const I2C_Worker&) = delete;
+	~I2C_Worker();
+
+	void post(std::function<void()> task);							// queues a request (yields while the queue is full)
+	bool onWorkerThread() const;									// determines whether the caller is the worker itself
+
+	template <class T>
+	std::future<T> submit(std::function<T()> request) {				// queues a request, its result is delivered through the future
+		std::shared_ptr<std::packaged_task<T()>> task = std::make_shared<std::packaged_task<T()>>(request);
+		std::future<T> result = task->get_future();
+		post([task]() { (*task)(); });
+		return result;
+	}
+};
+
+#endif // I2C_WORKER
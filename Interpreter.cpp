@@ -14,28 +14,65 @@
 #include <fstream>
 #include <cstdio>
 #include "ManageHistory.h"
+#include "Log.h"
 
 
-Interpreter::Interpreter(UHF_Transceiver* transceiver) {
+template <class Bus>
+Interpreter<Bus>::Interpreter(UHF_Transceiver<Bus>* transceiver, File_Worker* files) {
     this->transceiver = transceiver;
+    this->files = files;
+    upload_failed = false;
 
     last_file.telecommand = 0x00;
     last_file.num_packets = 0;
     packet_cntr = 0;
+    framer = nullptr;
 }
 
-command_t Interpreter::getCommand() {
-    int n = transceiver->getRxBufferCount();
+template <class Bus>
+void Interpreter<Bus>::setFramer(HDLC_Framer* framer) {
+    this->framer = framer;
+    frames.clear();
+}
+
+template <class Bus>
+command_t Interpreter<Bus>::getCommand() {
+    return getCommand(transceiver->getRxBufferCount());
+}
+
+template <class Bus>
+command_t Interpreter<Bus>::getCommand(int n) {
     packet_t inbound_packet;
     command_t inbound_command;
 
-    if (n == 0) return {0x00, "\0"};
+    if (n == 0 && frames.empty()) return {0x00, "\0"};
+
+    if (n > RX_FIFO_LEN) {
+        LOG_ERROR("Receive buffer count %d exceeds the %d byte buffer.", n, RX_FIFO_LEN);
+        n = RX_FIFO_LEN;
+    }
+    uint8_t* data = rx_data;
+    if (n > 0 && !transceiver->readNBytes(n, data)) {
+        LOG_ERROR("Lost %d received bytes to a failed read.", n);
+        return {0x00, "\0"};
+    }
 
-    uint8_t data[n];
-    transceiver->readNBytes(n, data);
-    inbound_packet = composePacket(data, n);
+    /* in transparent mode the buffer holds raw line bytes: a read may finish no packet, or several */
+    if (framer) {
+        framer->deframe(data, n, [this](const uint8_t* frame, int len) { frames.emplace_back((const char*)frame, len); });
+        if (frames.empty()) return {0x00, "\0"};
+
+        std::string packet;
+        packet.swap(frames.front());
+        frames.pop_front();
+        if (packet.length() < PACKET_MIN_LEN) return rejectPacket(packet.length());
+        inbound_packet = composePacket((uint8_t*)&packet[0], packet.length());
+    } else {
+        if (n < PACKET_MIN_LEN) return rejectPacket(n);
+        inbound_packet = composePacket(data, n);
+    }
     inbound_command = composeCommand(&inbound_packet);
-    addToHistory(&inbound_command);
+    recordCommand(inbound_command);
 
     if (inbound_command.telecommand == TELECOM_UPLOAD_FILE) {
         uploadFile(&inbound_command);
@@ -44,8 +81,21 @@ command_t Interpreter::getCommand() {
     return inbound_command;
 }
 
-packet_t Interpreter::composePacket(uint8_t* data_arr, int n) {
-    std::string data = (char*)data_arr;
+template <class Bus>
+command_t Interpreter<Bus>::rejectPacket(int n) {
+    /* too short to hold a telecommand; it is answered like any other malformed packet */
+    LOG_WARN("Dropped a %d byte packet (at least %d expected).", n, PACKET_MIN_LEN);
+    return {TELECOM_PACKET_FORMAT_ERR, ""};
+}
+
+template <class Bus>
+void Interpreter<Bus>::recordCommand(const command_t& command) {
+    files->submit([entry = command]() mutable { addToHistory(&entry); return 0; });
+}
+
+template <class Bus>
+packet_t Interpreter<Bus>::composePacket(uint8_t* data_arr, int n) {
+    std::string data((char*)data_arr, n);      // binary parameters may hold zeros
 
     packet_t inbound_packet;
     inbound_packet.preamble = (data_arr[0] << 8) | (data_arr[1] & 0xFF);
@@ -56,7 +106,8 @@ packet_t Interpreter::composePacket(uint8_t* data_arr, int n) {
     return inbound_packet;
 }
 
-command_t Interpreter::composeCommand(packet_t* inbound_packet) {
+template <class Bus>
+command_t Interpreter<Bus>::composeCommand(packet_t* inbound_packet) {
     command_t inbound_command;
     inbound_command.telecommand = (uint8_t)inbound_packet->data.at(0);
     inbound_command.params = inbound_packet->data.substr(1);
@@ -64,13 +115,15 @@ command_t Interpreter::composeCommand(packet_t* inbound_packet) {
     return inbound_command;
 }
 
-void Interpreter::backupFile(const std::string& filename) {
+template <class Bus>
+void Interpreter<Bus>::backupFile(const std::string& filename) {
     std::string newname = filename + BACKUP_EXT;
     remove(newname.c_str());                       // delete the backup file if the backup already exists
     rename(filename.c_str(), newname.c_str());     // create a new backup file if the file already exists
 }
 
-void Interpreter::restoreBackup(const std::string& filename) {
+template <class Bus>
+void Interpreter<Bus>::restoreBackup(const std::string& filename) {
     std::string backupname = filename + BACKUP_EXT;
     remove(filename.c_str());
     rename(backupname.c_str(), filename.c_str());
@@ -89,21 +142,23 @@ void Interpreter::restoreBackup(const std::string& filename) {
  *
  * NOTE: End of File (EOF) must be in the last packet.
  */
-int Interpreter::uploadFile(command_t* incoming_command) {
+template <class Bus>
+int Interpreter<Bus>::uploadFile(command_t* incoming_command) {
     bool last_packet = false;
 
-    printf("First Char: '%d'\n", (int)incoming_command->params.at(0));
-    printf("Num Packets: '%d'\n", (int)incoming_command->params.at(1));
-    printf("Length of Dest: '%d'\n", (int)incoming_command->params.at(2));
+    LOG_DEBUG("First Char: '%d'", (int)incoming_command->params.at(0));
+    LOG_DEBUG("Num Packets: '%d'", (int)incoming_command->params.at(1));
+    LOG_DEBUG("Length of Dest: '%d'", (int)incoming_command->params.at(2));
 
     if (incoming_command->params.at(0) == 1) {
         /* this means that the transmission is a new transmission */
 
         if (packet_cntr != last_file.num_packets) {
             /* this means that not all packets from the last transmission were received */
-            std::cout << "ERROR: Not all packets were received. Accepting the new telecommand." << std::endl;
+            LOG_ERROR("Not all packets were received. Accepting the new telecommand.");
             incoming_command->telecommand = TELECOM_PACKET_LOSS_RESET;
-            restoreBackup(last_file.dest);
+            std::string dest = last_file.dest;
+            files->submit([this, dest]() { restoreBackup(dest); return 0; });
         }
 
         packet_cntr = 1;
@@ -114,7 +169,7 @@ int Interpreter::uploadFile(command_t* incoming_command) {
 
         uint8_t startOfData = 3 + last_file.len_dest;
         if (startOfData > DATAFIELD_LEN-1) {
-            std::cout << "ERROR: Improper packet format. The data field is said to start at byte " << std::to_string(startOfData) << ", which exceeds " << std::to_string(DATAFIELD_LEN-1) << ". Aborting." << std::endl;
+            LOG_ERROR("Improper packet format. The data field is said to start at byte %d, which exceeds %d. Aborting.", startOfData, DATAFIELD_LEN-1);
             incoming_command->telecommand = TELECOM_PACKET_FORMAT_ERR;
             return -1;
         }
@@ -122,38 +177,31 @@ int Interpreter::uploadFile(command_t* incoming_command) {
         char sof = incoming_command->params.at(startOfData);                        // location of SOF character
         if (sof != SOF) {
             /* SOF is supposed to by in the first packet but was not found */
-            std::cout << "ERROR: Unable to locate the Start of File (SOF) character. Aborting." << std::endl;
+            LOG_ERROR("Unable to locate the Start of File (SOF) character. Aborting.");
             incoming_command->telecommand = TELECOM_PACKET_FORMAT_ERR;
             return -1;
         }
 
-        backupFile(last_file.dest);                                                 // if the file exists, save a backup
-        std::ofstream newFile(last_file.dest.c_str(), std::ofstream::trunc);
-
-        if (!newFile.is_open()) {
-            /* The destination was not found. */
-            std::cout << "Error: The file destination: '" << last_file.dest << "' was not found." << std::endl;
+        if (writeUpload(incoming_command->params.substr(startOfData+1), true) < 0) {
             incoming_command->telecommand = TELECOM_PACKET_FORMAT_ERR;
             return -1;
         }
-        newFile << incoming_command->params.substr(startOfData+1);
-        newFile.close();
         return 0;
     }
 
     if (incoming_command->telecommand != last_file.telecommand) {
-        std::cout << "ERROR: The telecommand changed without anticipation." << std::endl;
+        LOG_ERROR("The telecommand changed without anticipation.");
         incoming_command->telecommand = TELECOM_PACKET_LOSS;
         return -1;
     }
 
     if (packet_cntr > last_file.num_packets) {
-        std::cout << "ERROR: Unexpected number of packets received. Expected " << std::to_string(last_file.num_packets) << ", Received: " << std::to_string(packet_cntr) << "." << std::endl;
+        LOG_ERROR("Unexpected number of packets received. Expected %d, Received: %d.", last_file.num_packets, packet_cntr);
         incoming_command->telecommand = ERROR;
         return -1;
     } else if (packet_cntr == last_file.num_packets) {
         if (incoming_command->params.back() != EOF) {
-            std::cout << "ERROR: Unable to locate the End of File (EOF) character." << std::endl;
+            LOG_ERROR("Unable to locate the End of File (EOF) character.");
             incoming_command->telecommand = TELECOM_PACKET_LOSS;
             return -1;
         }
@@ -162,20 +210,15 @@ int Interpreter::uploadFile(command_t* incoming_command) {
     }
 
     if (incoming_command->params.at(0) != ++packet_cntr) {
-        std::cout << "ERROR: Packet number " << std::to_string(packet_cntr) << " was lost." << std::endl;
+        LOG_ERROR("Packet number %d was lost.", packet_cntr);
         incoming_command->telecommand = TELECOM_PACKET_LOSS;
         return -1;
     }
 
-    std::ofstream file(last_file.dest.c_str(), std::ofstream::app);
-    if (!file.is_open()) {
-        /* this means that the destination was not found */
-        std::cout << "Error: The file destination: '" << last_file.dest << "' was not found." << std::endl;
+    if (writeUpload(incoming_command->params.substr(1), false) < 0) {
         incoming_command->telecommand = ERROR;
         return -1;
     }
-    file << incoming_command->params.substr(1);
-    file.close();
 
     if (last_packet) {
         incoming_command->telecommand = TELECOM_LAST_PACKET_RECEIVED;
@@ -184,13 +227,44 @@ int Interpreter::uploadFile(command_t* incoming_command) {
     return 0;
 }
 
+/*
+ * The write itself runs on the file thread. Run inline, a failure is reported for this
+ * packet; on the file thread it is only known later, and is reported for the next one.
+ */
+template <class Bus>
+int Interpreter<Bus>::writeUpload(const std::string& data, bool first) {
+    std::string dest = last_file.dest;
+
+    files->submit([this, dest, data, first]() {
+        if (first) backupFile(dest);                                                // if the file exists, save a backup
+        std::ofstream file(dest.c_str(), first ? std::ofstream::trunc : std::ofstream::app);
+        if (!file.is_open()) return -1;
+        file << data;
+        file.close();
+        return 0;
+    }, [this, dest](int status) {
+        if (status < 0) {
+            /* this means that the destination was not found */
+            LOG_ERROR("The file destination: '%s' was not found.", dest.c_str());
+            upload_failed = true;
+        }
+    });
+
+    if (upload_failed) {
+        upload_failed = false;
+        return -1;
+    }
+    return 0;
+}
+
 
 /********************************** Testing **********************************/
 int lineno = 0;
 #include <algorithm>
 #include <vector>
 
-command_t Interpreter::getCommandTest() {
+template <class Bus>
+command_t Interpreter<Bus>::getCommandTest() {
     packet_t inbound_packet;
     command_t inbound_command;
 
@@ -210,7 +284,7 @@ command_t Interpreter::getCommandTest() {
 
         inbound_packet = composePacket(data, data_len);
         inbound_command = composeCommand(&inbound_packet);
-        addToHistory(&inbound_command);
+        recordCommand(inbound_command);
 
         if (inbound_command.telecommand == TELECOM_UPLOAD_FILE) {
             uploadFile(&inbound_command);
@@ -220,4 +294,7 @@ command_t Interpreter::getCommandTest() {
     }
 
     return {0x00, "\0"};
-}
\ No newline at end of file
+}
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class Interpreter<I2C_Bus>;
@@ -17,26 +17,46 @@
 #include <string>
 #include <stdlib.h>
 #include <iostream>
+#include <deque>
 #include "UHF_Transceiver.h"
+#include "HDLC_Framer.h"
+#include "File_Worker.h"
 #include "telecommands.h"
 
 
+/************************** Defines ***************************/
+#define PACKET_MIN_LEN          5           // preamble (2), length, telecommand and checksum
+
+
 /************************ Interpreter *************************/
+template <class Bus>
 class Interpreter {
 private:
-    UHF_Transceiver* transceiver;
+    UHF_Transceiver<Bus>* transceiver;
     packet_t composePacket(uint8_t* data, int n);
     command_t composeCommand(packet_t* inbound_packet);
     void backupFile(const std::string& filename);
     void restoreBackup(const std::string& filename);
     int uploadFile(command_t* incoming_command);
+    int writeUpload(const std::string& data, bool first);
+    void recordCommand(const command_t& command);
+    command_t rejectPacket(int n);
 
     file_t last_file;
     uint8_t packet_cntr;
 
+    uint8_t rx_data[RX_FIFO_LEN];                   // the receive buffer is read into this, so a scan does not allocate
+    HDLC_Framer* framer;                            // deframes the receive buffer in transparent mode (0 in AX.25 mode)
+    std::deque<std::string> frames;                 // deframed packets not yet interpreted
+
+    File_Worker* files;                             // history and uploads are written here, off the service thread
+    bool upload_failed;                             // set by a write that failed on the file thread
+
 public:
-    explicit Interpreter(UHF_Transceiver* transceiver);
+    Interpreter(UHF_Transceiver<Bus>* transceiver, File_Worker* files);
     command_t getCommand();
+    command_t getCommand(int n);                    // same, when the receive buffer count is already known
+    void setFramer(HDLC_Framer* framer);
 
     /****** Testing ******/
     command_t getCommandTest();
@@ -0,0 +1,176 @@
+/****************************************************************************
+* LZ_Codec.cpp
+*
+* @about      : dependency-free LZ77 compression for the downlink. Data is
+*               cut into blocks of LZ_BLOCK_LEN bytes that are compressed
+*               independently, so the decoder needs no more memory than one
+*               block and a lost packet only costs the block it falls in.
+*               Each block is a run of sequences (as in LZ4): a token with
+*               the literal and match lengths, the literals, then a 16-bit
+*               offset back into the block. A block that would not shrink
+*               is stored as is.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#include <string.h>
+#include "LZ_Codec.h"
+
+
+static inline uint32_t read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static inline int extra_len(int len) {
+    return (len >= 15) ? (len - 15) / 255 + 1 : 0;
+}
+
+static inline int put_len(uint8_t* out, int len) {
+    int n = 0;
+    for (len -= 15; len >= 255; len -= 255) out[n++] = 255;
+    out[n++] = len;
+    return n;
+}
+
+/*
+ * Sequence:
+ * Bytes:   |   1   |      0-n      |   0-n    |      2      |     0-n     |
+ *          | token | literal ext.  | literals | offset (LE) | match ext.  |
+ *
+ * The token holds the literal count (high nibble) and the match length less LZ_MIN_MATCH (low nibble); a
+ * nibble of 15 continues in extension bytes, where 255 means another one follows. The last sequence of a
+ * block ends after its literals.
+ */
+static int put_sequence(uint8_t* out, int op, int cap, const uint8_t* literals, int lit_len, int offset, int match_len) {
+    int match_code = match_len ? match_len - LZ_MIN_MATCH : 0;
+    int need = 1 + extra_len(lit_len) + lit_len + (match_len ? 2 + extra_len(match_code) : 0);
+    if (op + need > cap) return -1;
+
+    uint8_t* token = &out[op++];
+    *token = ((lit_len < 15 ? lit_len : 15) << 4) | (match_code < 15 ? match_code : 15);
+    if (lit_len >= 15) op += put_len(&out[op], lit_len);
+    memcpy(&out[op], literals, lit_len);
+    op += lit_len;
+
+    if (match_len) {
+        out[op++] = offset & 0xFF;
+        out[op++] = offset >> 8;
+        if (match_code >= 15) op += put_len(&out[op], match_code);
+    }
+    return op;
+}
+
+int LZ_Codec::compressBlock(const uint8_t* in, int n, uint8_t* out, int cap) {
+    memset(table, 0, sizeof(table));
+    int ip = 0, anchor = 0, op = 0;
+
+    while (ip + LZ_MIN_MATCH <= n) {
+        uint32_t sequence = read32(&in[ip]);
+        uint32_t h = hash(sequence);
+        int ref = table[h] - 1;
+        table[h] = ip + 1;
+
+        if (ref < 0 || read32(&in[ref]) != sequence) {
+            ip += 1 + ((ip - anchor) >> 6);                         // strides grow through data that does not repeat
+            continue;
+        }
+
+        int len = LZ_MIN_MATCH;
+        while (ip + len < n && in[ref + len] == in[ip + len]) len++;
+
+        op = put_sequence(out, op, cap, &in[anchor], ip - anchor, ip - ref, len);
+        if (op < 0) return -1;
+        ip += len;
+        anchor = ip;
+    }
+
+    /* whatever is left goes out as literals, in a sequence without a match */
+    if (anchor < n || op == 0) op = put_sequence(out, op, cap, &in[anchor], n - anchor, 0, 0);
+    return op;
+}
+
+int LZ_Codec::packBlock(const uint8_t* in, int n, uint8_t* out) {
+    int body = compressBlock(in, n, &out[LZ_BLOCK_HEADER_LEN], n - 1);
+    uint16_t header = body;
+
+    if (body < 0) {
+        memcpy(&out[LZ_BLOCK_HEADER_LEN], in, n);
+        body = n;
+        header = LZ_STORED | n;
+    }
+    out[0] = header >> 8;
+    out[1] = header & 0xFF;
+    return LZ_BLOCK_HEADER_LEN + body;
+}
+
+int LZ_Codec::unpack(const uint8_t* in, size_t n, uint8_t* out, size_t cap) {
+    size_t ip = 0, op = 0;
+
+    while (ip < n) {
+        if (ip + LZ_BLOCK_HEADER_LEN > n) return -1;
+        uint16_t header = (in[ip] << 8) | in[ip + 1];
+        size_t body = header & ~LZ_STORED;
+        ip += LZ_BLOCK_HEADER_LEN;
+        if (body > n - ip) return -1;
+
+        if (header & LZ_STORED) {
+            if (body > cap - op) return -1;
+            memcpy(&out[op], &in[ip], body);
+            ip += body;
+            op += body;
+            continue;
+        }
+
+        /* offsets only reach back into the block being decoded */
+        size_t block_start = op, end = ip + body;
+        while (ip < end) {
+            uint8_t token = in[ip++];
+
+            size_t lit_len = token >> 4;
+            if (lit_len == 15) {
+                uint8_t b;
+                do {
+                    if (ip >= end) return -1;
+                    b = in[ip++];
+                    lit_len += b;
+                } while (b == 255);
+            }
+            if (lit_len > end - ip || lit_len > cap - op) return -1;
+            memcpy(&out[op], &in[ip], lit_len);
+            ip += lit_len;
+            op += lit_len;
+            if (ip == end) break;                                   // the last sequence has no match
+
+            if (ip + 2 > end) return -1;
+            size_t offset = in[ip] | (in[ip + 1] << 8);
+            ip += 2;
+            size_t match_len = token & 0x0F;
+            if (match_len == 15) {
+                uint8_t b;
+                do {
+                    if (ip >= end) return -1;
+                    b = in[ip++];
+                    match_len += b;
+                } while (b == 255);
+            }
+            match_len += LZ_MIN_MATCH;
+            if (offset == 0 || offset > op - block_start || match_len > cap - op) return -1;
+
+            /* byte by byte: a match may overlap the bytes it produces */
+            const uint8_t* ref = &out[op - offset];
+            for (size_t i = 0; i < match_len; i++) out[op + i] = ref[i];
+            op += match_len;
+        }
+    }
+    return op;
+}
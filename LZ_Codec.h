@@ -0,0 +1,64 @@
+/****************************************************************************
+* LZ_Codec.h
+*
+* @about      : dependency-free LZ77 compression for the downlink. Data is
+*               cut into blocks of LZ_BLOCK_LEN bytes that are compressed
+*               independently, so the decoder needs no more memory than one
+*               block and a lost packet only costs the block it falls in.
+*               Each block is a run of sequences (as in LZ4): a token with
+*               the literal and match lengths, the literals, then a 16-bit
+*               offset back into the block. A block that would not shrink
+*               is stored as is.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+
+/************************** Defines ***************************/
+
+#define LZ_BLOCK_LEN            4096        // raw bytes per block (the decoder's whole window)
+#define LZ_HASH_BITS            12          // match table entries (2 bytes each)
+#define LZ_MIN_MATCH            4           // shortest match worth a sequence
+#define LZ_BLOCK_HEADER_LEN     2           // big-endian: LZ_STORED and the length of the block's body
+#define LZ_STORED               0x8000      // the body is the raw data
+#define LZ_MAX_BLOCK_LEN        (LZ_BLOCK_HEADER_LEN + LZ_BLOCK_LEN)   // longest packed block
+#define LZ_MIN_INPUT            64          // shorter data is not worth compressing
+
+
+/* Stream format: | header (2) | body | header (2) | body | ... (one per block, each LZ_BLOCK_LEN raw bytes but the last) */
+
+struct lz_stats_t {
+    uint64_t downlinks;                     // compressed downlinks
+    uint64_t raw_bytes;                     // their size before compression
+    uint64_t packed_bytes;                  // and after (block headers included)
+    uint64_t cpu_ns;                        // thread CPU time spent compressing them
+};
+
+
+/************************** Codec *****************************/
+
+class LZ_Codec {
+private:
+    uint16_t table[1 << LZ_HASH_BITS];      // latest position (+1) of each hashed 4-byte sequence in the block
+
+    int compressBlock(const uint8_t* in, int n, uint8_t* out, int cap);
+
+public:
+    int packBlock(const uint8_t* in, int n, uint8_t* out);                  // packs up to LZ_BLOCK_LEN bytes, returns the packed length
+    static int unpack(const uint8_t* in, size_t n, uint8_t* out, size_t cap);  // decodes a whole stream, returns its raw length (-1 if malformed)
+};
+
+#endif // LZ_CODEC_H
@@ -0,0 +1,99 @@
+ /****************************************************************************
+ * Log.cpp
+ *
+ * @about      : leveled logging. Statements above LOG_LEVEL (make LOG=n)
+ *               compile to nothing, arguments included; enabled ones are
+ *               formatted into a lock-free ring buffer and printed by
+ *               log_flush(), off the bus paths.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include "Log.h"
+
+/* bounded multi-producer queue (D. Vyukov, as in I2C_Worker): each record's sequence number says whose turn it is */
+struct log_record_t {
+	std::atomic<size_t> sequence;
+	int level;
+	const char* file;
+	char text[LOG_RECORD_LEN];
+};
+
+static log_record_t ring[LOG_RING_LEN];
+static std::atomic<size_t> enqueue_pos(0), dequeue_pos(0);
+static std::atomic<uint32_t> dropped(0);
+
+static const char* level_names[] = {"", "ERROR", "WARNING", "INFO", "DEBUG"};
+
+/* numbers the records and installs the exit flush before main() runs */
+static struct log_init_t {
+	log_init_t() {
+		for (size_t i = 0; i < LOG_RING_LEN; i++) ring[i].sequence.store(i, std::memory_order_relaxed);
+		atexit(log_flush);
+	}
+} log_init;
+
+void log_write(int level, const char* file, const char* format, ...) {
+	size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+	log_record_t* record;
+
+	while (true) {
+		record = &ring[pos & (LOG_RING_LEN - 1)];
+		size_t seq = record->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+		if (diff == 0) {
+			if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		} else if (diff < 0) {
+			dropped.fetch_add(1, std::memory_order_relaxed);		// full: never block the caller
+			return;
+		} else {
+			pos = enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(record->text, LOG_RECORD_LEN, format, args);
+	va_end(args);
+	record->level = level;
+	record->file = file;
+	record->sequence.store(pos + 1, std::memory_order_release);
+}
+
+void log_flush() {
+	size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+
+	while (true) {
+		log_record_t* record = &ring[pos & (LOG_RING_LEN - 1)];
+		size_t seq = record->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+		if (diff == 0) {
+			if (!dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) continue;
+			printf("%s: %s (%s)\n", level_names[record->level], record->text, record->file);
+			record->sequence.store(pos + LOG_RING_LEN, std::memory_order_release);
+			pos++;
+		} else if (diff < 0) {
+			break;													// empty
+		} else {
+			pos = dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+	if (lost) printf("WARNING: %u log records dropped (ring full).\n", lost);
+	fflush(stdout);
+}
+
+uint32_t log_dropped() {
+	return dropped.load(std::memory_order_relaxed);
+}
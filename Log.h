@@ -0,0 +1,70 @@
+/****************************************************************************
+* Log.h
+*
+* @about      : leveled logging. Statements above LOG_LEVEL (make LOG=n)
+*               compile to nothing, arguments included; enabled ones are
+*               formatted into a lock-free ring buffer and printed by
+*               log_flush(), off the bus paths.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef LOG_H
+#define LOG_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+
+
+/*************************** Defines ***************************/
+
+#define LOG_LEVEL_NONE		0
+#define LOG_LEVEL_ERROR		1
+#define LOG_LEVEL_WARN		2
+#define LOG_LEVEL_INFO		3
+#define LOG_LEVEL_DEBUG		4
+
+/* a disabled statement is dead code: never evaluated or formatted, but its format string is still checked */
+#ifndef LOG_LEVEL
+#define LOG_LEVEL			LOG_LEVEL_WARN		// errors and warnings only
+#endif
+
+#define LOG_RING_LEN		256		// queued records (must be a power of two)
+#define LOG_RECORD_LEN		120		// longest message, longer ones are truncated
+
+
+void log_write(int level, const char* file, const char* format, ...) __attribute__((format(printf, 3, 4)));	// queues a record (dropped if the ring is full)
+void log_flush();															// prints every queued record
+uint32_t log_dropped();														// records lost since the last flush
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...)		log_write(LOG_LEVEL_ERROR, __FILE__, __VA_ARGS__)
+#else
+#define LOG_ERROR(...)		do { if (0) log_write(LOG_LEVEL_ERROR, __FILE__, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...)		log_write(LOG_LEVEL_WARN, __FILE__, __VA_ARGS__)
+#else
+#define LOG_WARN(...)		do { if (0) log_write(LOG_LEVEL_WARN, __FILE__, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...)		log_write(LOG_LEVEL_INFO, __FILE__, __VA_ARGS__)
+#else
+#define LOG_INFO(...)		do { if (0) log_write(LOG_LEVEL_INFO, __FILE__, __VA_ARGS__); } while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)		log_write(LOG_LEVEL_DEBUG, __FILE__, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...)		do { if (0) log_write(LOG_LEVEL_DEBUG, __FILE__, __VA_ARGS__); } while (0)
+#endif
+
+#endif // LOG_H
@@ -33,6 +33,9 @@ void cleanHistory() {
     while (std::getline(history, line)) ++num_lines;
     history.close();
 
+    /* nothing to drop, so the file is not rewritten */
+    if (num_lines <= LEAVE_LAST_N) return;
+
     /* deleting all but the last LEAVE_LAST_N files */
     history.open(HISTORY_FILENAME);
     std::ofstream tempFile;
@@ -40,7 +43,7 @@ void cleanHistory() {
 
     while(std::getline(history,line)) {
         if (num_lines - ++line_cntr < LEAVE_LAST_N) {
-            tempFile << line;
+            tempFile << line << "\n";       // getline() drops the line break
         }
     }
 
@@ -12,145 +12,538 @@
  ****************************************************************************/
 
 #include <iostream>
+#include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
 #include "Packager.h"
+#include "Log.h"
 
 
-Packager::Packager(UHF_Transceiver* transceiver) {
+template <class Bus>
+Packager<Bus>::Packager(UHF_Transceiver<Bus>* transceiver) {
     this->transceiver = transceiver;
+    this->framer = nullptr;
+    in_flight = nullptr;
+    next_slot = 0;
+    compress = false;
+    lz_stats = {};
+    memset(window_number, 0, sizeof(window_number));
+    window_id = 0;
+    arq_stats = {};
 }
 
-int Packager::sendString(const std::string &str) {
-    int status = sendData(TELECOM_DOWNLINK_STRING, str);
-    return status;
+template <class Bus>
+Packager<Bus>::~Packager() {
+    flush();                                    // the bus worker may still be reading our frame buffers
 }
 
-int Packager::sendFile(const std::string &filename) {
-    std::ifstream outFile(filename);
-
-    if (outFile.is_open()) {
-        /* saving the contents of the file to the string 'buffer' */
-        outFile.seekg(0, std::ios::end);
-        size_t size = outFile.tellg();
-        std::string buffer(size, ' ');
-        outFile.seekg(0);
-        outFile.read(&buffer[0], size);
-        outFile.close();
-
-        sendData(TELECOM_DOWNLINK_FILE, buffer);
-
-        return 0;
+template <class Bus>
+void Packager<Bus>::setFramer(HDLC_Framer* framer) {
+    flush();                                    // a frame already queued keeps the framing it was built with
+    this->framer = framer;
+    for (std::vector<uint8_t>& buffer : line) {
+        buffer.assign(framer ? framer->maxFramedLen(PACKET_MAX_LEN) : 0, 0);
     }
+}
 
+template <class Bus>
+int Packager<Bus>::sendString(const std::string &str) {
+    int status = sendData(TELECOM_DOWNLINK_STRING, str);
+    return status;
+}
+
+template <class Bus>
+int Packager<Bus>::sendFileUnavailable() {
     /* the file was unavailable, sending an error */
     std::string err;
     err += (char)TELECOM_FILE_UNAVAILABLE;
-    sendString(err);
-
-    return -1;
+    return sendString(err);
 }
 
-packet_t Packager::composePacket(const std::string &data) {
-    packet_t outbound;
-    outbound.checksum = getChecksum(data);
-    outbound.data_length = (uint8_t)data.length()-1;
-    outbound.data = data;
-    outbound.preamble = TRANSMIT_PREAMBLE;
+/*
+ * Packet:
+ * Bytes:   |    2     |        1        |   1-256    |    1     |
+ *          | preamble | data length - 1 | data field | checksum |
+ *
+ * The whole packet is written in place, so each payload byte is copied exactly once (from
+ * the caller's view into the frame buffer). Returns the length of the packet.
+ */
+template <class Bus>
+int Packager<Bus>::buildPacket(uint8_t* packet, const downlink_stream_t* stream, std::string_view payload) {
+    uint8_t* field = &packet[3];
+    int len = 0;
+
+    field[len++] = stream->telecom;
+    field[len++] = (uint8_t)(stream->next_packet >> 8);
+    field[len++] = (uint8_t)(stream->next_packet & 0xFF);
+    if (stream->next_packet == 1) {
+        field[len++] = (uint8_t)(stream->num_packets >> 8);
+        field[len++] = (uint8_t)(stream->num_packets & 0xFF);
+    }
+    memcpy(&field[len], payload.data(), payload.length());
+    len += payload.length();
+
+    packet[0] = (uint8_t)(TRANSMIT_PREAMBLE >> 8);
+    packet[1] = (uint8_t)(TRANSMIT_PREAMBLE & 0xFF);
+    packet[2] = (uint8_t)(len - 1);
+    field[len] = getChecksum(field, len);
 
-    return outbound;
+    return len + PACKET_OVERHEAD - 1;
 }
 
-int Packager::sendPacket(packet_t* outbound) {
-    std::string data;
+template <class Bus>
+int Packager<Bus>::sendPacket(int slot, const uint8_t* packet, int len) {
+    tx_span_t* span = &spans[slot];
+    span->data = packet;
+    span->n = len;
 
-    data += (char)(outbound->preamble >> 8);
-    data += (char)(outbound->preamble & 0xFF);
-    data += (char)outbound->data_length;
-    data += outbound->data;
-    data += (char)outbound->checksum;
+    /* in transparent mode the transceiver sends the bytes as they are, so the HDLC frame is built here */
+    if (framer) {
+        span->n = framer->frame(packet, len, line[slot].data());
+        span->data = line[slot].data();
+    }
 
-    uint8_t str_len = outbound->data_length + PACKET_OVERHEAD;
-    transceiver->sendString(data, str_len);
-    return 0;
+    /* the next frame was composed while this one was on the bus; wait for it before queueing another */
+    int status = flush();
+    transceiver->sendNBytesAsync(span);
+    in_flight = span;
+    return status;
 }
 
-uint8_t Packager::getChecksum(const std::string &data) {
+template <class Bus>
+int Packager<Bus>::flush() {
+    if (!in_flight) return 0;
+    int status = in_flight->wait();
+    in_flight = nullptr;
+    return status;
+}
+
+template <class Bus>
+uint8_t Packager<Bus>::getChecksum(const uint8_t* data, int n) {
     uint8_t sum = 0;
 
-    for (char i : data) {
-        sum += (uint8_t)i;
+    for (int i = 0; i < n; i++) {
+        sum += data[i];
     }
 
     return sum;
 }
 
-int Packager::getNumPackets(const std::string &data) {
-    int len = data.length() + 1;                // (length of data) + 1 byte (number of packets' field in packet #1)
-    return (len - 1) / (DATAFIELD_LEN - 2) + 1; // 256 bytes (in AX.25 frame) - 1 byte (telecom), - 1 byte (packet number) = 254
+template <class Bus>
+size_t Packager<Bus>::getNumPackets(size_t len) {
+    if (len <= FIRST_PACKET_DATA_LEN) return 1;
+    return 1 + (len - FIRST_PACKET_DATA_LEN + NEXT_PACKET_DATA_LEN - 1) / NEXT_PACKET_DATA_LEN;
 }
 
 /*
  * First Packet:
- * Bytes:        1      |      1        |       1           |  0-253 |
+ * Bytes:        1      |       2       |         2         |  0-251 |
  *          telecommand | packet number | number of packets |  data  |
  *
  *
  * Other Packets:
- * Bytes:        1      |      1        |  1-254 |
+ * Bytes:        1      |       2       |  1-253 |
  *          telecommand | packet number |  data  |
  *
+ * Both counters are big-endian.
  */
-int Packager::sendData(uint8_t telecom, const std::string &data) {
-    int num_packets = getNumPackets(data);
+template <class Bus>
+int Packager<Bus>::sendData(uint8_t telecom, std::string_view data) {
+    if (compress && data.length() >= LZ_MIN_INPUT && packedTelecom(telecom)) {
+        int status = sendPacked(packedTelecom(telecom), data);
+        if (status <= 0) return status;         // otherwise it did not shrink
+    }
+
+    downlink_stream_t stream;
+    if (beginStream(&stream, telecom, data.length()) < 0) return -1;
+    int status = streamChunk(&stream, data);
+    if (endStream(&stream) < 0) status = -1;
+    return status;
+}
 
-    /* sending the first packet */
-    std::string data_out;
-    int first_packet_data_len = DATAFIELD_LEN-3;
-    data_out += (char)telecom;
-    data_out += (char)1;
-    data_out += (char)num_packets;
-    data_out += data.substr(0, first_packet_data_len);
-    send256Bytes(data_out);
+/* packs the data twice, once to size the downlink and once on the way out; returns 1 (nothing sent) if it does not shrink */
+template <class Bus>
+int Packager<Bus>::sendPacked(uint8_t telecom, std::string_view data) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
 
-    for (int i = 0; i < num_packets-1; i++) {
-        data_out = data.substr(i*DATAFIELD_LEN + first_packet_data_len, DATAFIELD_LEN);
-        send256Bytes(data_out);
+    size_t len = 0;
+    for (size_t i = 0; i < data.length(); i += LZ_BLOCK_LEN) {
+        std::string_view block = data.substr(i, LZ_BLOCK_LEN);
+        len += codec.packBlock((const uint8_t*)block.data(), block.length(), packed);
     }
+    if (len >= data.length()) return 1;
+
+    downlink_stream_t stream;
+    if (beginStream(&stream, telecom, len) < 0) return -1;
+    int status = 0;
+    for (size_t i = 0; i < data.length(); i += LZ_BLOCK_LEN) {
+        std::string_view block = data.substr(i, LZ_BLOCK_LEN);
+        int n = codec.packBlock((const uint8_t*)block.data(), block.length(), packed);
+        if (streamChunk(&stream, std::string_view((const char*)packed, n)) < 0) status = -1;
+    }
+    if (endStream(&stream) < 0) status = -1;
 
-    std::cout << "Number of Packets: " << num_packets << std::endl;
-    return 0;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &end);
+    recordPacked("string", data.length(), len, (end.tv_sec - start.tv_sec) * 1000000000ULL + end.tv_nsec - start.tv_nsec);
+    return status;
 }
 
-int Packager::send256Bytes(const std::string &str) {
-    if (str.length() > 256) {
-        std::cout << "ERROR: Attempting to send more than 256 bytes." << std::endl;
+template <class Bus>
+int Packager<Bus>::beginStream(downlink_stream_t* stream, uint8_t telecom, size_t len) {
+    size_t num_packets = getNumPackets(len);
+    if (num_packets > MAX_DOWNLINK_PACKETS) {
+        LOG_ERROR("Unable to downlink %zu bytes (at most %zu fit in %d packets).", len, (size_t)MAX_DOWNLINK_LEN, MAX_DOWNLINK_PACKETS);
         return -1;
     }
 
-    packet_t outbound = composePacket(str);
-    sendPacket(&outbound);
+    stream->telecom = telecom;
+    stream->num_packets = num_packets;
+    stream->next_packet = 1;
+    stream->carry_len = 0;
+    stream->window = openWindow(num_packets);
+    stream->recording = 0;
+    return 0;
+}
+
+template <class Bus>
+int Packager<Bus>::sendStreamPacket(downlink_stream_t* stream, std::string_view payload) {
+    /* frames alternate between the slots: the one being built is never the one on the bus */
+    int len = buildPacket(packets[next_slot], stream, payload);
+    if (stream->recording) cache.append(stream->recording, packets[next_slot], len);
+    sent(packets[next_slot], len, stream->window, stream->next_packet);
+    int status = sendPacket(next_slot, packets[next_slot], len);
+    next_slot = (next_slot + 1) % TX_SLOTS;
+    stream->next_packet++;
+    return status;
+}
+
+template <class Bus>
+int Packager<Bus>::streamChunk(downlink_stream_t* stream, std::string_view chunk) {
+    int status = 0;
+
+    while (!chunk.empty()) {
+        size_t room = (stream->next_packet == 1) ? FIRST_PACKET_DATA_LEN : NEXT_PACKET_DATA_LEN;
+
+        /* whole packets are framed straight from the chunk; only the ends of a misaligned one are carried */
+        if (stream->carry_len == 0 && chunk.length() >= room) {
+            if (sendStreamPacket(stream, chunk.substr(0, room)) < 0) status = -1;
+            chunk.remove_prefix(room);
+            continue;
+        }
+
+        size_t take = std::min(room - stream->carry_len, chunk.length());
+        memcpy(&stream->carry[stream->carry_len], chunk.data(), take);
+        stream->carry_len += take;
+        chunk.remove_prefix(take);
+
+        if ((size_t)stream->carry_len == room) {
+            if (sendStreamPacket(stream, std::string_view((const char*)stream->carry, room)) < 0) status = -1;
+            stream->carry_len = 0;
+        }
+    }
+
+    return status;
+}
+
+template <class Bus>
+int Packager<Bus>::endStream(downlink_stream_t* stream) {
+    int status = 0;
+
+    /* the short last packet, or the only one of an empty downlink */
+    if (stream->carry_len || stream->next_packet == 1) {
+        status = sendStreamPacket(stream, std::string_view((const char*)stream->carry, stream->carry_len));
+        stream->carry_len = 0;
+    }
+
+    if (flush() < 0) status = -1;
+    transceiver->endTxStream();                 // the last frame is queued; the FIFO may now drain
+    return status;
+}
+
+/************ Cached Downlinks ************/
+
+template <class Bus>
+Frame_Cache& Packager<Bus>::getCache() {
+    return cache;
+}
+
+/* the packets go out as they were cached; in transparent mode they are still framed here, because the
+   scrambler runs on from whatever was sent last */
+template <class Bus>
+int Packager<Bus>::sendFrames(const cached_frames_t* frames) {
+    int status = 0;
+    const uint8_t* packet = frames->bytes.data();
+    uint32_t window = openWindow(frames->lens.size());
+    uint32_t number = 1;
+
+    for (uint16_t len : frames->lens) {
+        sent(packet, len, window, number++);
+        if (sendPacket(next_slot, packet, len) < 0) status = -1;
+        next_slot = (next_slot + 1) % TX_SLOTS;
+        packet += len;
+    }
+
+    if (flush() < 0) status = -1;               // the cache may change once this returns
+    transceiver->endTxStream();
+    return status;
+}
+
+/************* Retransmission *************/
+
+/* a single packet is cheaper to request again than to keep, so only multi-packet downlinks get a window */
+template <class Bus>
+uint32_t Packager<Bus>::openWindow(size_t num_packets) {
+    if (num_packets < 2) return 0;
+    memset(window_number, 0, sizeof(window_number));
+    if (++window_id == 0) window_id = 1;
+    return window_id;
+}
+
+template <class Bus>
+void Packager<Bus>::sent(const uint8_t* packet, int len, uint32_t window, uint32_t number) {
+    arq_stats.packets++;
+    arq_stats.bytes += len;
+
+    /* a downlink that started meanwhile owns the window now */
+    if (!window || window != window_id) return;
+    int slot = number % ARQ_WINDOW_PACKETS;
+    memcpy(this->window[slot], packet, len);
+    window_len[slot] = len;
+    window_number[slot] = number;
+}
+
+/*
+ * TELECOM_RETRANSMIT parameters (packet numbers as downlinked, from 1):
+ * Bytes:   |     2     |     2      |     2     |     2      | ...
+ *          | first (BE) | last (BE) | first (BE) | last (BE) | ...
+ */
+template <class Bus>
+int Packager<Bus>::retransmit(std::string_view ranges) {
+    if (ranges.empty() || ranges.length() % ARQ_RANGE_LEN) return -1;
+
+    /* every range is checked before any packet goes out, so a malformed request sends nothing */
+    const uint8_t* range = (const uint8_t*)ranges.data();
+    for (size_t i = 0; i < ranges.length(); i += ARQ_RANGE_LEN) {
+        uint32_t first = (range[i] << 8) | range[i + 1];
+        uint32_t last = (range[i + 2] << 8) | range[i + 3];
+        if (first == 0 || last < first) return -1;
+    }
+    arq_stats.requests++;
+
+    int status = 0, resent = 0;
+    for (size_t i = 0; i < ranges.length(); i += ARQ_RANGE_LEN) {
+        uint32_t first = (range[i] << 8) | range[i + 1];
+        uint32_t last = (range[i + 2] << 8) | range[i + 3];
+        for (uint32_t number = first; number <= last; number++) {
+            int slot = number % ARQ_WINDOW_PACKETS;
+            if (window_number[slot] != number) {
+                arq_stats.unavailable++;
+                continue;
+            }
+            if (sendPacket(next_slot, window[slot], window_len[slot]) < 0) status = -1;
+            next_slot = (next_slot + 1) % TX_SLOTS;
+            arq_stats.resent++;
+            arq_stats.resent_bytes += window_len[slot];
+            resent++;
+        }
+    }
+
+    if (flush() < 0) status = -1;               // the next downlink may reuse the window's slots
+    transceiver->endTxStream();
+    if (status < 0) LOG_ERROR("Retransmission failed after %d packets.", resent);
+    return resent;
+}
+
+template <class Bus>
+const arq_stats_t& Packager<Bus>::getArqStats() const {
+    return arq_stats;
+}
+
+/************** Compression **************/
+
+template <class Bus>
+void Packager<Bus>::setCompression(bool enable) {
+    if (enable != compress) cache.clear();      // the cached packets were built the other way
+    compress = enable;
+}
+
+template <class Bus>
+uint8_t Packager<Bus>::packedTelecom(uint8_t telecom) {
+    switch (telecom) {
+        case TELECOM_DOWNLINK_FILE:   return TELECOM_DOWNLINK_FILE_LZ;
+        case TELECOM_DOWNLINK_STRING: return TELECOM_DOWNLINK_STRING_LZ;
+        default:                      return 0;
+    }
+}
+
+template <class Bus>
+void Packager<Bus>::recordPacked(const char* name, size_t raw, size_t packed, uint64_t cpu_ns) {
+    lz_stats.downlinks++;
+    lz_stats.raw_bytes += raw;
+    lz_stats.packed_bytes += packed;
+    lz_stats.cpu_ns += cpu_ns;
+    LOG_INFO("Packed %s: %zu -> %zu bytes (%.2fx) in %.3f ms of CPU.", name, raw, packed, packed ? (double)raw / packed : 0.0, cpu_ns / 1e6);
+}
+
+template <class Bus>
+const lz_stats_t& Packager<Bus>::getCompressionStats() const {
+    return lz_stats;
+}
+
+template <class Bus>
+void Packager<Bus>::printStats() {
+    std::cout << std::dec << "Downlink Compression (" << (compress ? "on" : "off") << "):" << std::endl;
+    std::cout << "\tDownlinks: " << lz_stats.downlinks << ", Raw: " << lz_stats.raw_bytes << " bytes, Packed: " << lz_stats.packed_bytes << " bytes";
+    if (lz_stats.packed_bytes) std::cout << " (" << (double)lz_stats.raw_bytes / lz_stats.packed_bytes << "x)";
+    std::cout << ", CPU: " << lz_stats.cpu_ns / 1e6 << " ms" << std::endl;
+    cache.printStats();
+
+    std::cout << "Retransmission (window of " << ARQ_WINDOW_PACKETS << " packets):" << std::endl;
+    std::cout << "\tRequests: " << arq_stats.requests << ", Resent: " << arq_stats.resent << " of " << arq_stats.packets << " packets";
+    if (arq_stats.packets) std::cout << " (" << 100.0 * arq_stats.resent / arq_stats.packets << "%)";
+    std::cout << ", Unavailable: " << arq_stats.unavailable << std::endl;
+    uint64_t total = arq_stats.bytes + arq_stats.resent_bytes;
+    std::cout << "\tEffective Goodput: " << (total ? 100.0 * arq_stats.bytes / total : 0) << "% of the packet bytes sent were new" << std::endl;
+}
+
+/************* File Downlink *************/
+
+static uint64_t thread_cpu_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
 
-    std::cout << "Outbound Data: " << outbound.data << std::endl;
-    std::cout << "Outbound Data Length: " << outbound.data_length << std::endl;
+int downlink_file_t::open(const std::string& filename, bool pack) {
+    close();
+    fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
 
+    struct stat info;
+    if (fstat(fd, &info) < 0 || !S_ISREG(info.st_mode)) {
+        close();
+        return -1;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    key.path = filename;
+    key.mtime_ns = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+    key.size = info.st_size;
+    raw_size = size = info.st_size;
+    raw_offset = offset = 0;
+    packed = false;
+    cpu_ns = 0;
+    if (!pack || raw_size < LZ_MIN_INPUT) return 0;
+
+    /* the packet count goes out first, so the packed length has to be known before the first packet */
+    uint8_t* scratch = buffers[1];
+    size_t len = 0;
+    while (raw_offset < raw_size) {
+        int n = packNext(scratch);
+        if (n < 0) {
+            close();
+            return -1;
+        }
+        len += n;
+    }
+    raw_offset = 0;
+    if (len < raw_size) {
+        packed = true;
+        size = len;
+    }
     return 0;
 }
 
+int downlink_file_t::readRaw(size_t n) {
+    size_t got = 0;
+    while (got < n) {
+        ssize_t r = pread(fd, &raw[got], n - got, raw_offset + got);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return -1;                  // read error, or the file shrank after it was opened
+        got += r;
+    }
+    raw_offset += got;
+    return got;
+}
+
+int downlink_file_t::packNext(uint8_t* out) {
+    size_t n = std::min((size_t)LZ_BLOCK_LEN, raw_size - raw_offset);
+    if (readRaw(n) < 0) return -1;
+
+    uint64_t start = thread_cpu_ns();
+    int len = codec.packBlock(raw, n, out);
+    cpu_ns += thread_cpu_ns() - start;
+    return len;
+}
+
+int downlink_file_t::readChunk(int buffer) {
+    uint8_t* out = buffers[buffer];
+
+    if (packed) {
+        /* as many whole blocks as fit; the stream carries packets across chunks */
+        size_t got = 0;
+        while (raw_offset < raw_size && DOWNLINK_CHUNK_LEN - got >= LZ_MAX_BLOCK_LEN) {
+            int n = packNext(&out[got]);
+            if (n < 0) return -1;
+            got += n;
+        }
+        if (offset + got > size || (raw_offset == raw_size && offset + got != size)) return -1;   // the file changed since the first pass
+        offset += got;
+        return got;
+    }
+
+    /* every chunk ends on a packet boundary, so no packet has to be carried */
+    size_t want = (offset == 0) ? FIRST_PACKET_DATA_LEN + (DOWNLINK_CHUNK_PACKETS - 1) * NEXT_PACKET_DATA_LEN : DOWNLINK_CHUNK_LEN;
+    if (want > size - offset) want = size - offset;
+
+    size_t got = 0;
+    while (got < want) {
+        ssize_t n = pread(fd, &out[got], want - got, offset + got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;                  // read error, or the file shrank after it was opened
+        got += n;
+    }
+    offset += got;
+    return got;
+}
+
+bool downlink_file_t::done() const {
+    return offset >= size;
+}
+
+void downlink_file_t::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
 /************** Debug ***************/
 
-void Packager::debug_toggle(int led) {
+template <class Bus>
+void Packager<Bus>::debug_toggle(int led) {
 	transceiver->ledToggle(led);
 }
 
-void Packager::debug_on(int led) {
+template <class Bus>
+void Packager<Bus>::debug_on(int led) {
 	transceiver->ledOn(led);
 }
 
-void Packager::debug_off(int led) {
+template <class Bus>
+void Packager<Bus>::debug_off(int led) {
 	transceiver->ledOff(led);
 }
 
-void Packager::transmitStringTest(std::string data, uint8_t str_len) {
+template <class Bus>
+void Packager<Bus>::transmitStringTest(std::string data, uint8_t str_len) {
     transceiver->sendStringTest(data, str_len);
-}
\ No newline at end of file
+}
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class Packager<I2C_Bus>;
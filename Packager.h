@@ -17,36 +17,149 @@
 
 /************************** Includes **************************/
 #include <string>
+#include <string_view>
+#include <vector>
 #include "telecommands.h"
 #include "UHF_Transceiver.h"
+#include "HDLC_Framer.h"
+#include "LZ_Codec.h"
+#include "Frame_Cache.h"
 
 
 /************************** Defines ***************************/
 #define TRANSMIT_PREAMBLE      0x1ACF
 #define DATAFIELD_LEN          256      // bytes
 #define PACKET_OVERHEAD 	   5 		// bytes
+#define PACKET_MAX_LEN         (DATAFIELD_LEN + PACKET_OVERHEAD - 1)   // preamble, length, full data field, checksum
+#define FIRST_PACKET_DATA_LEN  (DATAFIELD_LEN - 5)                     // after the telecommand, packet number and number of packets
+#define NEXT_PACKET_DATA_LEN   (DATAFIELD_LEN - 3)                     // after the telecommand and packet number
+#define MAX_DOWNLINK_PACKETS   0xFFFF                                  // the packet counters are 16 bits wide
+#define MAX_DOWNLINK_LEN       (FIRST_PACKET_DATA_LEN + (size_t)(MAX_DOWNLINK_PACKETS - 1) * NEXT_PACKET_DATA_LEN)
+#define TX_SLOTS               2        // one frame is built while the other is on the bus
+#define DOWNLINK_CHUNK_PACKETS 32       // packets read from a file at a time
+#define DOWNLINK_CHUNK_LEN     (DOWNLINK_CHUNK_PACKETS * NEXT_PACKET_DATA_LEN)
+#define ARQ_WINDOW_PACKETS     256      // packets of the last multi-packet downlink kept for retransmission
+#define ARQ_RANGE_LEN          4        // first and last packet number of a retransmission range (2 bytes each, BE)
+
+
+/* a downlink in progress, fed a piece at a time; a packet is only held back while its data is incomplete */
+struct downlink_stream_t {
+    uint8_t telecom;
+    uint16_t num_packets;
+    uint32_t next_packet;                       // number of the next packet to go out (from 1)
+    uint8_t carry[NEXT_PACKET_DATA_LEN];        // data of the next packet, when a piece ended in the middle of it
+    int carry_len;
+    uint32_t window;                            // the retransmit window its packets are kept in (0: not kept)
+    uint32_t recording;                         // the frame cache recording its packets go into (0: none)
+};
+
+struct arq_stats_t {
+    uint64_t packets;                           // packets sent for the first time
+    uint64_t bytes;                             // and their bytes
+    uint64_t requests;                          // TELECOM_RETRANSMIT commands
+    uint64_t resent;                            // packets sent again
+    uint64_t resent_bytes;
+    uint64_t unavailable;                       // requested packets no longer in the window
+};
+
+/* a file downlinked a chunk at a time, so memory use does not grow with its size; the reads
+   belong on the file thread, and only one of them may be outstanding at a time */
+struct downlink_file_t {
+    int fd = -1;
+    frame_key_t key;                            // the file as it was opened
+    bool packed = false;                        // the file goes down as an LZ_Codec stream
+    size_t size = 0;                            // bytes to downlink (the file's, or those of its packed stream)
+    size_t offset = 0;                          // bytes handed out so far
+    size_t raw_size = 0;                        // bytes in the file when it was opened
+    size_t raw_offset = 0;                      // next byte of the file to read
+    uint64_t cpu_ns = 0;                        // thread CPU time spent packing
+    LZ_Codec codec;
+    uint8_t raw[LZ_BLOCK_LEN];
+    uint8_t buffers[2][DOWNLINK_CHUNK_LEN];     // one chunk is read while the other is framed
+
+    int open(const std::string& filename, bool pack = false);   // packing sizes the stream with a first pass over the file
+    int readChunk(int buffer);                  // reads the next chunk, returns its length (-1 on error or if the file changed)
+    bool done() const;                          // every byte has been handed out
+    void close();
+
+private:
+    int readRaw(size_t n);                      // reads the next 'n' bytes of the file into 'raw'
+    int packNext(uint8_t* out);                 // packs the next block of the file into 'out', returns its length
+};
 
 
 /************************** Packager **************************/
+template <class Bus>
 class Packager {
 private:
-    UHF_Transceiver* transceiver;
+    UHF_Transceiver<Bus>* transceiver;
+    HDLC_Framer* framer;                        // frames packets on the host in transparent mode (0 in AX.25 mode)
 
-    packet_t composePacket(const std::string &data);
-    int sendPacket(packet_t* outbound);
-    static uint8_t getChecksum(const std::string &data);
-    int getNumPackets(const std::string &data);
-    int sendData(uint8_t telecom, const std::string &data);
-    int send256Bytes(const std::string &str);
+    /* reusable frame buffers: nothing is allocated per frame */
+    uint8_t packets[TX_SLOTS][PACKET_MAX_LEN];
+    std::vector<uint8_t> line[TX_SLOTS];        // HDLC-framed packets, sized once per setFramer()
+    tx_span_t spans[TX_SLOTS];
+    tx_span_t* in_flight;                       // the frame currently being pushed into TX_DATA
+    int next_slot;
+
+    int flush();
+
+    /* Compression */
+    bool compress;                              // downlinks that shrink go out as TELECOM_*_LZ
+    LZ_Codec codec;
+    uint8_t packed[LZ_MAX_BLOCK_LEN];
+    lz_stats_t lz_stats;
+
+    Frame_Cache cache;                          // packets of recent file downlinks, ready to go out again
+
+    /* Retransmission: packet n of the last multi-packet downlink is kept in slot n % ARQ_WINDOW_PACKETS */
+    uint8_t window[ARQ_WINDOW_PACKETS][PACKET_MAX_LEN];
+    uint16_t window_len[ARQ_WINDOW_PACKETS];
+    uint32_t window_number[ARQ_WINDOW_PACKETS]; // packet held in each slot (0: none)
+    uint32_t window_id;                         // bumped for every multi-packet downlink
+    arq_stats_t arq_stats;
+
+    uint32_t openWindow(size_t num_packets);
+    void sent(const uint8_t* packet, int len, uint32_t window, uint32_t number);
+
+    int buildPacket(uint8_t* packet, const downlink_stream_t* stream, std::string_view payload);
+    int sendPacket(int slot, const uint8_t* packet, int len);
+    int sendStreamPacket(downlink_stream_t* stream, std::string_view payload);
+    static uint8_t getChecksum(const uint8_t* data, int n);
+    static size_t getNumPackets(size_t len);
+    int sendData(uint8_t telecom, std::string_view data);
+    int sendPacked(uint8_t telecom, std::string_view data);
 
     /* Test Functions */
 	void transmitStringTest(std::string data, uint8_t str_len);
 
 public:
-    explicit Packager(UHF_Transceiver* transceiver);
+    explicit Packager(UHF_Transceiver<Bus>* transceiver);
+    ~Packager();
 
     int sendString(const std::string &str);
-    int sendFile(const std::string &filename);
+    int sendFileUnavailable();
+
+    /* Streaming */
+    int beginStream(downlink_stream_t* stream, uint8_t telecom, size_t len);   // -1 if 'len' needs more than MAX_DOWNLINK_PACKETS
+    int streamChunk(downlink_stream_t* stream, std::string_view chunk);       // frames every packet the chunk completes
+    int endStream(downlink_stream_t* stream);                                 // sends the last packet and waits for it
+    void setFramer(HDLC_Framer* framer);
+
+    /* Cached Downlinks */
+    Frame_Cache& getCache();                    // a stream is recorded once its 'recording' is set from Frame_Cache::record()
+    int sendFrames(const cached_frames_t* frames);                            // sends a cached downlink and waits for it
+
+    /* Retransmission */
+    int retransmit(std::string_view ranges);    // resends the packets in 'ranges' still in the window, returns how many (-1 if malformed)
+    const arq_stats_t& getArqStats() const;
+
+    /* Compression */
+    void setCompression(bool enable);
+    static uint8_t packedTelecom(uint8_t telecom);                            // the TELECOM_*_LZ form of a downlink (0 if none)
+    void recordPacked(const char* name, size_t raw, size_t packed, uint64_t cpu_ns);
+    const lz_stats_t& getCompressionStats() const;
+    void printStats();
 
     /* Test Functions */
 	void debug_toggle(int led);
@@ -0,0 +1,104 @@
+/****************************************************************************
+* RX_Poller.cpp
+*
+* @about      : decides how long the radio may sleep between receive polls.
+*               Polls tightly while an uplink session is active and backs
+*               off exponentially toward a low duty cycle when idle.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#include <string.h>
+#include <iostream>
+#include "RX_Poller.h"
+
+
+RX_Poller::RX_Poller(const poll_config_t& config) {
+    configure(config);
+    resetStats();
+
+    delay_ms = this->config.min_ms;
+    last_packet_cnt = 0;
+    have_packet_cnt = false;
+    last_activity = clock::now();
+    last_poll = last_activity;
+}
+
+void RX_Poller::configure(const poll_config_t& config) {
+    this->config = config;
+    if (this->config.min_ms == 0) this->config.min_ms = 1;
+    if (this->config.max_ms < this->config.min_ms) this->config.max_ms = this->config.min_ms;
+}
+
+bool RX_Poller::observe(uint16_t rx_count, uint16_t packet_cnt) {
+    clock::time_point now = clock::now();
+
+    /* a packet counter step means traffic even if the bytes were already drained elsewhere */
+    bool active = rx_count > 0 || (have_packet_cnt && packet_cnt != last_packet_cnt);
+    last_packet_cnt = packet_cnt;
+    have_packet_cnt = true;
+
+    stats.polls++;
+    if (active) {
+        stats.active_polls++;
+        last_activity = now;
+    } else {
+        last_poll = now;                                        // the data arrived after this poll at the earliest
+    }
+    return active;
+}
+
+void RX_Poller::respond() {
+    /* worst case: the command landed right after the previous (empty) poll */
+    uint64_t latency_us = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - last_poll).count();
+    last_poll = clock::now();
+
+    stats.responses++;
+    stats.total_latency_us += latency_us;
+    if (latency_us > stats.max_latency_us) stats.max_latency_us = latency_us;
+
+    uint64_t ms = latency_us / 1000;
+    int b = 0;
+    while (ms && b < POLL_LATENCY_BUCKETS - 1) {
+        ms >>= 1;
+        b++;
+    }
+    stats.histogram[b]++;
+}
+
+uint32_t RX_Poller::update() {
+    uint64_t idle_ms = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - last_activity).count();
+
+    if (idle_ms < config.hold_ms) delay_ms = config.min_ms;    // session active: poll tightly
+    else                          delay_ms *= POLL_BACKOFF;     // idle: back off
+
+    if (delay_ms < config.min_ms) delay_ms = config.min_ms;
+    if (delay_ms > config.max_ms) delay_ms = config.max_ms;
+
+    stats.slept_ms += delay_ms;
+    return delay_ms;
+}
+
+const poll_stats_t& RX_Poller::getStats() const {
+    return stats;
+}
+
+void RX_Poller::resetStats() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void RX_Poller::printStats() {
+    std::cout << std::dec;
+    std::cout << "RX Poller Statistics (" << config.min_ms << "-" << config.max_ms << " ms):" << std::endl;
+    std::cout << "\tPolls: " << stats.polls << ", Active: " << stats.active_polls << ", Slept: " << stats.slept_ms << " ms" << std::endl;
+    std::cout << "\tResponses: " << stats.responses << ", Avg Latency: "
+              << (stats.responses ? stats.total_latency_us / stats.responses / 1000.0 : 0) << " ms, Max Latency: "
+              << stats.max_latency_us / 1000.0 << " ms" << std::endl;
+    std::cout << "\tLatency Histogram (ms: <1 <2 <4 ...):";
+    for (int b = 0; b < POLL_LATENCY_BUCKETS; b++) std::cout << " " << stats.histogram[b];
+    std::cout << std::endl;
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+* RX_Poller.h
+*
+* @about      : decides how long the radio may sleep between receive polls.
+*               Polls tightly while an uplink session is active and backs
+*               off exponentially toward a low duty cycle when idle.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef RX_POLLER_H
+#define RX_POLLER_H
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <chrono>
+
+
+/************************** Defines ***************************/
+
+#define POLL_MIN_MS             5           // poll period during an active session
+#define POLL_MAX_MS             1000        // idle poll period (the former fixed sleep)
+#define POLL_HOLD_MS            5000        // a session stays active this long after the last packet
+#define POLL_BACKOFF            2           // idle period growth per empty poll
+#define POLL_LATENCY_BUCKETS    12          // latency histogram buckets: [0, 1), [1, 2), [2, 4) ... ms
+
+
+struct poll_config_t {
+    uint32_t min_ms;                        // shortest delay between polls
+    uint32_t max_ms;                        // longest delay between polls
+    uint32_t hold_ms;                       // time without traffic before backing off
+};
+
+struct poll_stats_t {
+    uint32_t polls;                         // receive polls issued
+    uint32_t active_polls;                  // polls that found new data
+    uint32_t responses;                     // commands serviced
+    uint64_t total_latency_us;              // sum of the command-to-response latencies
+    uint64_t max_latency_us;                // worst command-to-response latency
+    uint32_t histogram[POLL_LATENCY_BUCKETS];
+    uint64_t slept_ms;                      // total delay handed out
+};
+
+
+/************************** Poller ****************************/
+
+class RX_Poller {
+private:
+    typedef std::chrono::steady_clock clock;
+
+    poll_config_t config;
+    poll_stats_t stats;
+    uint32_t delay_ms;                      // delay handed out by the last update()
+    uint16_t last_packet_cnt;               // RX_PACKET_CNTR at the previous poll
+    bool have_packet_cnt;
+    clock::time_point last_activity;        // last time the receiver had something for us
+    clock::time_point last_poll;            // time of the previous poll
+
+public:
+    explicit RX_Poller(const poll_config_t& config = {POLL_MIN_MS, POLL_MAX_MS, POLL_HOLD_MS});
+    void configure(const poll_config_t& config);                // changes the bounds (clamped to min <= max)
+
+    bool observe(uint16_t rx_count, uint16_t packet_cnt);       // records a poll, returns whether there is new data
+    void respond();                                             // records that the command found by the last poll was answered
+    uint32_t update();                                          // returns the delay until the next poll, in ms
+
+    const poll_stats_t& getStats() const;
+    void resetStats();
+    void printStats();
+};
+
+#endif //RX_POLLER_H
@@ -15,95 +15,188 @@
 #include<fstream>
 
 
-Radio::Radio() {
-    transceiver = new UHF_Transceiver();
-    handler = new Handler(transceiver);
-    interpreter = new Interpreter(transceiver);
+template <class Bus>
+Radio<Bus>::Radio() : framer({LINK_SCRAMBLE_VAL, HDLC_DEFAULT_FLAGS}) {
+    transceiver = new UHF_Transceiver<Bus>();
+    handler = new Handler<Bus>(transceiver, &files);
+    interpreter = new Interpreter<Bus>(transceiver, &files);
+    handler->setCompression(DOWNLINK_COMPRESS_VAL);
+    handler->setCacheLimit(FRAME_CACHE_BYTES_VAL);
 
     config();
-    configBeacon();
 }
 
-void Radio::config() {
+template <class Bus>
+void Radio<Bus>::config() {
+    auto start = std::chrono::steady_clock::now();
+    uint32_t transactions = transceiver->getBusStats().transactions;
+
     pa_pwr_lvl = PA_POWER_VAL;
     cnt_since_healthcheck = 0;
-
-    transceiver->setModemConfig(MODEM_CONFIG_VAL);
-    transceiver->setPAPower(pa_pwr_lvl);
-    transceiver->setRxFreq(FREQ_VAL);
-    transceiver->setTxFreq(FREQ_VAL);
-    transceiver->setMode(AX25_MODE);
-
-    // resolveLock();
+    last_housekeeping = start;
+
+    /* the whole configuration goes out in one transaction and comes back in one readback */
+    urtx_profile_t profile = {MODEM_CONFIG_VAL, pa_pwr_lvl, FREQ_VAL, FREQ_VAL,
+                              BEACON_INIT_TIMEOUT, BEACON_RECURRING_TIMEOUT, LINK_MODE_VAL};
+    if (transceiver->applyProfile(profile) < 0) {
+        LOG_WARN("The startup profile did not verify, rewriting the registers that differ.");
+        transceiver->repairConfig();
+    }
+    attachFramer(LINK_MODE_VAL);
+    transceiver->configureTxStream();
+    lock_wait_ms = resolveLock();
+
+    startup_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    startup_transactions = transceiver->getBusStats().transactions - transactions;
+    LOG_INFO("Configured in %u us and %u transactions (frequency lock after %d ms).",
+             (unsigned)startup_us, (unsigned)startup_transactions, lock_wait_ms);
 }
 
-void Radio::configBeacon() {
-    transceiver->setInitialTimeout(BEACON_INIT_TIMEOUT);
-    transceiver->setRecurringTimeout(BEACON_RECURRING_TIMEOUT);
+template <class Bus>
+int Radio<Bus>::resolveLock() {
+    return transceiver->waitForLock(LOCK_TIMEOUT_MS);     // ms waited, -1 if unable to establish frequency lock
 }
 
-int Radio::resolveLock() {
-    int cntr = 0;
-    while (!transceiver->testLocks() && cntr < 10) {
-        sleep(0.15);
-        cntr++;
-    }
-    if (cntr >= 10) return -1;  // unable to establish frequency lock
-    return 0;                   // frequency locked
-}
+template <class Bus>
+void Radio<Bus>::healthCheck() {
+    cnt_since_healthcheck = 0;
 
-void Radio::healthCheck() {
-    if (transceiver->getModemConfig() != MODEM_CONFIG_VAL) {
-        transceiver->setModemConfig(MODEM_CONFIG_VAL);
-    }
+    /* served from the transceiver's shadow registers, so this costs no bus traffic unless the level changed */
     if (transceiver->getPAPower() != pa_pwr_lvl) {
         transceiver->setPAPower(pa_pwr_lvl);
     }
-    if (transceiver->getTxFreq() != FREQ_VAL) {
-        transceiver->setTxFreq(FREQ_VAL);
-    }
-    if (transceiver->getRxFreq() != FREQ_VAL) {
-        transceiver->setRxFreq(FREQ_VAL);
-    }
-    if (transceiver->getInitialTimeout() != BEACON_INIT_TIMEOUT) {
-        transceiver->setInitialTimeout(BEACON_INIT_TIMEOUT);
-    }
-    if (transceiver->getRecurringTimeout() != BEACON_RECURRING_TIMEOUT) {
-        transceiver->setInitialTimeout(BEACON_RECURRING_TIMEOUT);
-    }
 
-    cnt_since_healthcheck = 0;
+    transceiver->repairConfig();
+
     // resolveLock();
 }
 
-uint8_t Radio::getPowerLevel() const {
+template <class Bus>
+uint8_t Radio<Bus>::getPowerLevel() const {
     return pa_pwr_lvl;
 }
 
-void Radio::setPowerLevel(uint8_t pa_pwr_lvl) {
+template <class Bus>
+void Radio<Bus>::setPowerLevel(uint8_t pa_pwr_lvl) {
     this->pa_pwr_lvl = pa_pwr_lvl;
 }
 
-void Radio::enableRadio() {
+template <class Bus>
+void Radio<Bus>::enableRadio() {
     pa_pwr_lvl = PA_POWER_VAL;
 }
 
-void Radio::disableRadio() {
+template <class Bus>
+void Radio<Bus>::disableRadio() {
     pa_pwr_lvl = PA_LVL_INHIBIT;
 }
 
-int Radio::scan() {
+template <class Bus>
+int Radio<Bus>::scan() {
+    I2C_PROFILE_TICK();
+    files.service();
     if (cnt_since_healthcheck++ > CHECK_HEALTH_EVERY_N_SCANS) healthCheck();
 
     command_t incoming_command = interpreter->getCommand();
     int status = handler->process(&incoming_command);
 
+    housekeeping();
+    return status;
+}
+
+template <class Bus>
+void Radio<Bus>::housekeeping() {
     std::string beacon_msg = "TEST!";
     updateBeacon(beacon_msg);
+    last_housekeeping = std::chrono::steady_clock::now();
+    files.submit([]() { log_flush(); return 0; });
+}
+
+template <class Bus>
+uint32_t Radio<Bus>::poll() {
+    uint16_t rx_count, packet_cnt;
+
+    /* downlinks and upload results whose file I/O has finished go out first */
+    files.service();
+
+    /* one transaction tells us whether anything arrived; commands are answered as soon as they are seen */
+    if (transceiver->getRxStatus(&rx_count, &packet_cnt) == 0 && poller.observe(rx_count, packet_cnt) && rx_count) {
+        I2C_PROFILE_TICK();
+        command_t incoming_command = interpreter->getCommand(rx_count);
+        handler->process(&incoming_command);
+        poller.respond();
+    }
+
+    /* the beacon and health check keep their once-a-second cadence however fast we poll */
+    if (std::chrono::steady_clock::now() - last_housekeeping >= std::chrono::milliseconds(HOUSEKEEPING_PERIOD_MS)) {
+        if (cnt_since_healthcheck++ > CHECK_HEALTH_EVERY_N_SCANS) healthCheck();
+        housekeeping();
+    }
+
+    return poller.update();
+}
+
+template <class Bus>
+RX_Poller& Radio<Bus>::getPoller() {
+    return poller;
+}
+
+template <class Bus>
+void Radio<Bus>::setLinkMode(uint8_t mode) {
+    transceiver->setMode(mode);
+    attachFramer(mode);
+}
+
+template <class Bus>
+void Radio<Bus>::attachFramer(uint8_t mode) {
+    /* AX.25 is framed by the transceiver; in the transparent modes both directions go through our framer */
+    HDLC_Framer* host_framer = (mode == AX25_MODE) ? nullptr : &framer;
+    framer.reset();
+    handler->setFramer(host_framer);
+    interpreter->setFramer(host_framer);
+}
+
+template <class Bus>
+HDLC_Framer& Radio<Bus>::getFramer() {
+    return framer;
+}
+
+template <class Bus>
+void Radio<Bus>::setCompression(bool enable) {
+    handler->setCompression(enable);
+}
+
+template <class Bus>
+void Radio<Bus>::printBusStats() {
+    std::cout << std::dec << "Startup: " << startup_us / 1000.0 << " ms, " << startup_transactions << " transactions, Frequency Lock: ";
+    if (lock_wait_ms < 0) std::cout << "none" << std::endl;
+    else                  std::cout << lock_wait_ms << " ms" << std::endl;
+    transceiver->printBusStats();
+    poller.printStats();
+    handler->printStats();
+}
+
+template <class Bus>
+int Radio<Bus>::enableRealtime(const rt_config_t& rt) {
+    /* started first, so the file thread stays an ordinary time-shared thread */
+    files.start();
+
+    int status = rt_lock_memory();
+    if (rt_enter_thread(rt) < 0) status = -1;
+    if (transceiver->runOnWorker([rt]() { return rt_enter_thread(rt); }) < 0) status = -1;
+
+    LOG_INFO("Real-time mode on CPU %d at SCHED_FIFO %d%s.", rt.cpu, rt.priority, status < 0 ? " (partially refused)" : "");
     return status;
 }
 
-Radio::~Radio() {
+template <class Bus>
+File_Worker& Radio<Bus>::getFileWorker() {
+    return files;
+}
+
+template <class Bus>
+Radio<Bus>::~Radio() {
+    files.stop();                                     // the queued I/O still refers to the handler and interpreter
     delete(transceiver);
     delete(handler);
     delete(interpreter);
@@ -111,42 +204,50 @@ Radio::~Radio() {
 
 /********************* Beacon Functions *********************/
 
-void Radio::enableBeacon() {
+template <class Bus>
+void Radio<Bus>::enableBeacon() {
     transceiver->enableBeacon();
 }
 
-void Radio::disableBeacon() {
+template <class Bus>
+void Radio<Bus>::disableBeacon() {
     transceiver->disableBeacon();
 }
 
-void Radio::updateBeacon(const std::string& str) {
+template <class Bus>
+void Radio<Bus>::updateBeacon(const std::string& str) {
     transceiver->setBeaconOutput(str);
 }
 
-void Radio::updateBeaconCSV(const std::string& filename) {
+template <class Bus>
+void Radio<Bus>::updateBeaconCSV(const std::string& filename) {
     std::ifstream ifs(filename);
     std::string content((std::istreambuf_iterator<char>(ifs)),
                         (std::istreambuf_iterator<char>()));
     updateBeacon(content);
 }
 
-uint8_t Radio::getBeaconStatus() {
+template <class Bus>
+uint8_t Radio<Bus>::getBeaconStatus() {
     return transceiver->getBeaconCtrl();
 }
 
 /********************** Test Functions **********************/
 
-Radio::Radio(int setting) {
-    transceiver = new UHF_Transceiver();
-    handler = new Handler(transceiver);
-    interpreter = new Interpreter(transceiver);
+template <class Bus>
+Radio<Bus>::Radio(int setting) : framer({LINK_SCRAMBLE_VAL, HDLC_DEFAULT_FLAGS}) {
+    transceiver = new UHF_Transceiver<Bus>();
+    handler = new Handler<Bus>(transceiver, &files);
+    interpreter = new Interpreter<Bus>(transceiver, &files);
+    handler->setCompression(DOWNLINK_COMPRESS_VAL);
+    handler->setCacheLimit(FRAME_CACHE_BYTES_VAL);
 
     config();
     test_config(setting);
-    configBeacon();
 }
 
-void Radio::test_config(int setting) {
+template <class Bus>
+void Radio<Bus>::test_config(int setting) {
     switch(setting) {
         case 0: 
             transceiver->setPAPower(PA_LVL_27);
@@ -160,21 +261,27 @@ void Radio::test_config(int setting) {
     }
 }
 
-int Radio::test_scan() {
+template <class Bus>
+int Radio<Bus>::test_scan() {
+    files.service();
     if (cnt_since_healthcheck++ > CHECK_HEALTH_EVERY_N_SCANS) healthCheck();
 
 	command_t incoming_command = interpreter->getCommandTest();
 	int status = handler->process(&incoming_command);
     
-    std::string beacon_msg = "TEST!";
-    updateBeacon(beacon_msg);
+    housekeeping();
     return status;
 }
 
-void Radio::toggle_led(int led) {
+template <class Bus>
+void Radio<Bus>::toggle_led(int led) {
     transceiver->ledToggle(led);
 }
 
-void Radio::sendString(std::string str) {
+template <class Bus>
+void Radio<Bus>::sendString(std::string str) {
     transceiver->sendString(str, str.length());
-}
\ No newline at end of file
+}
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class Radio<I2C_Bus>;
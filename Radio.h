@@ -17,6 +17,10 @@
 #include "UHF_Transceiver.h"
 #include "Handler.h"
 #include "Interpreter.h"
+#include "RX_Poller.h"
+#include "HDLC_Framer.h"
+#include "File_Worker.h"
+#include "Realtime.h"
 
 
 #define MODEM_CONFIG_VAL            MODEM_GMSK_BOTH
@@ -25,19 +29,38 @@
 #define BEACON_INIT_TIMEOUT         5                 // 5 minutes
 #define BEACON_RECURRING_TIMEOUT    120               // 120 seconds
 #define CHECK_HEALTH_EVERY_N_SCANS  10
+#define HOUSEKEEPING_PERIOD_MS      1000              // beacon refresh and health check cadence when polling
+#define LINK_MODE_VAL               AX25_MODE         // TRANS_MODE_CONV_* frames on the host (see HDLC_Framer.h)
+#define LINK_SCRAMBLE_VAL           true              // G3RUH scrambling of host-framed data
+#define LOCK_TIMEOUT_MS             1000              // longest wait for both synthesizers to lock at startup
+#define RT_CPU_VAL                  RT_DEFAULT_CPU    // CPU of the service and bus threads in real-time mode
+#define RT_PRIORITY_VAL             RT_DEFAULT_PRIORITY
+#define DOWNLINK_COMPRESS_VAL       false             // true: downlinks that shrink go out as TELECOM_*_LZ (the ground has to decode LZ_Codec)
+#define FRAME_CACHE_BYTES_VAL       FRAME_CACHE_DEFAULT_BYTES   // packets of repeated file downlinks kept in memory
 
 
+template <class Bus>
 class Radio {
 private:
-    UHF_Transceiver* transceiver;
-    Handler* handler;
-    Interpreter* interpreter;
+    UHF_Transceiver<Bus>* transceiver;
+    Handler<Bus>* handler;
+    Interpreter<Bus>* interpreter;
 
     uint8_t pa_pwr_lvl;
     uint8_t cnt_since_healthcheck;
+    RX_Poller poller;
+    HDLC_Framer framer;                               // used while the transceiver is in a transparent mode
+    File_Worker files;                                // history, uploads, downlinked files and the log, off the service thread
+    std::chrono::steady_clock::time_point last_housekeeping;
+
+    /* Startup */
+    uint32_t startup_us;                              // time spent in config()
+    uint32_t startup_transactions;                    // bus transactions issued by config()
+    int lock_wait_ms;                                 // wait for frequency lock at startup (-1 if it never came)
 
     void config();
-    void configBeacon();
+    void attachFramer(uint8_t mode);
+    void housekeeping();
     int resolveLock();
 
 public:
@@ -48,6 +71,14 @@ public:
     void enableRadio();
     void disableRadio();
     int scan();
+    uint32_t poll();                                  // services the receiver, returns how long to sleep (ms)
+    RX_Poller& getPoller();
+    void setLinkMode(uint8_t mode);                   // AX25_MODE, or a transparent mode with host-side framing
+    HDLC_Framer& getFramer();
+    void setCompression(bool enable);
+    void printBusStats();
+    int enableRealtime(const rt_config_t& rt = {RT_CPU_VAL, RT_PRIORITY_VAL});  // call from the service thread (-1 if part of it was refused)
+    File_Worker& getFileWorker();
     ~Radio();
 
     /* Beacon Functions */
@@ -0,0 +1,89 @@
+ /****************************************************************************
+ * Realtime.cpp
+ *
+ * @about      : opt-in real-time execution for the radio's service threads.
+ *               Locks the process in memory, pre-faults the heap and the
+ *               thread stacks, and moves a thread to SCHED_FIFO on a chosen
+ *               CPU, so a busy flight computer cannot delay RX polling or TX
+ *               refills with page faults or time slicing.
+ * @author     : Carlos Carrasquillo
+ * @contact    : c.carrasquillo@ufl.edu
+ * @date       : October 17, 2026
+ * @modified   : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <errno.h>
+#include <stdint.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "Realtime.h"
+#include "Log.h"
+
+void rt_prefault(void* buffer, size_t n) {
+	static long page = sysconf(_SC_PAGESIZE);
+	volatile uint8_t* bytes = (volatile uint8_t*)buffer;
+	for (size_t i = 0; i < n; i += page) bytes[i] = bytes[i];
+	if (n) bytes[n - 1] = bytes[n - 1];
+}
+
+/* a frame this deep, written once, leaves that much stack resident for good (mlockall keeps it) */
+static void __attribute__((noinline)) prefault_stack() {
+	volatile uint8_t stack[RT_STACK_PREFAULT];
+	rt_prefault((void*)stack, sizeof(stack));
+}
+
+int rt_lock_memory() {
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+		LOG_ERROR("mlockall() failed: %s (needs CAP_IPC_LOCK or a larger RLIMIT_MEMLOCK).", strerror(errno));
+		return -1;
+	}
+
+	/* freed memory stays in the heap instead of going back to the kernel, so it never faults in again */
+	mallopt(M_TRIM_THRESHOLD, -1);
+	mallopt(M_MMAP_MAX, 0);
+
+	void* heap = malloc(RT_HEAP_PREFAULT);
+	if (heap) {
+		rt_prefault(heap, RT_HEAP_PREFAULT);
+		free(heap);
+	}
+	return 0;
+}
+
+int rt_enter_thread(const rt_config_t& config) {
+	int status = 0;
+
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	if (config.cpu >= online) {
+		/* a single-core board has nothing to pin to; the priority still applies */
+		LOG_WARN("CPU %d is not online (%ld online), leaving the thread unpinned.", config.cpu, online);
+	} else if (config.cpu >= 0) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(config.cpu, &cpus);
+		int err = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+		if (err) {
+			LOG_ERROR("Unable to pin the thread to CPU %d: %s.", config.cpu, strerror(err));
+			status = -1;
+		}
+	}
+
+	struct sched_param param;
+	memset(&param, 0, sizeof(param));
+	param.sched_priority = config.priority;
+	int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+	if (err) {
+		LOG_ERROR("Unable to make the thread SCHED_FIFO %d: %s (needs CAP_SYS_NICE).", config.priority, strerror(err));
+		status = -1;
+	}
+
+	prefault_stack();
+	return status;
+}
@@ -0,0 +1,46 @@
+/****************************************************************************
+* Realtime.h
+*
+* @about      : opt-in real-time execution for the radio's service threads.
+*               Locks the process in memory, pre-faults the heap and the
+*               thread stacks, and moves a thread to SCHED_FIFO on a chosen
+*               CPU, so a busy flight computer cannot delay RX polling or TX
+*               refills with page faults or time slicing.
+* @author     : Carlos Carrasquillo
+* @contact    : c.carrasquillo@ufl.edu
+* @date       : October 17, 2026
+* @modified   : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+
+/************************** Includes **************************/
+
+#include <stddef.h>
+
+
+/*************************** Defines ***************************/
+
+#define RT_DEFAULT_CPU			1					// CPU the service threads are pinned to (-1: no pinning)
+#define RT_DEFAULT_PRIORITY		80					// SCHED_FIFO priority of the service threads (1 - 99)
+#define RT_STACK_PREFAULT		(256 * 1024)		// stack touched up front by each service thread
+#define RT_HEAP_PREFAULT		(4 * 1024 * 1024)	// heap faulted in (and kept) before entering real-time mode
+
+
+struct rt_config_t {
+	int cpu;										// CPU to pin the service threads to (-1: no pinning)
+	int priority;									// SCHED_FIFO priority (1 - 99)
+};
+
+
+/************************* Functions **************************/
+
+int rt_lock_memory();								// mlockall()s the process and keeps freed heap mapped, then pre-faults RT_HEAP_PREFAULT of it
+int rt_enter_thread(const rt_config_t& config);		// pins the calling thread, makes it SCHED_FIFO and pre-faults its stack
+void rt_prefault(void* buffer, size_t n);			// touches every page of a buffer
+
+#endif // REALTIME_H
@@ -13,457 +13,962 @@
  ****************************************************************************/
 
 #include "UHF_Transceiver.h"
+#include "Conversions.h"
 
+#define UHF_INFO(...)	do { if (debug) LOG_INFO(__VA_ARGS__); } while (0)
 
-UHF_Transceiver::UHF_Transceiver(bool debug, uint8_t bus) {
+
+/* downlink bit rate for a MODEM_CONFIG value */
+static uint32_t line_rate(uint8_t modem_config) {
+	return (modem_config & MODEM_GMSK_DOWN) ? TX_GMSK_BPS : TX_AFSK_BPS;
+}
+
+/* ALMOST_EMPTY_THRESHOLD that leaves TX_LOW_WATER_MS of airtime in the FIFO */
+static uint16_t low_water(uint8_t modem_config) {
+	return line_rate(modem_config) / 8 * TX_LOW_WATER_MS / 1000;
+}
+
+
+/* bits of each configuration register that are mirrored in the shadow copy (0 = not a configuration register) */
+static constexpr uint8_t config_mask[CONFIG_BLOCK_LEN] = {
+	0x03, 0xFF, 0xFF, 0x00,		// MODEM_CONFIG, AX25_TX_DELAY, SYNC_BYTES, TX_DATA
+	0x01, 0x00, 0x03, 0x03,		// BEACON_CTRL (clear bit self-clears), BEACON_DATA, PA_POWER_LVL, RX_OFFSET (high)
+	0xFF, 0x01, 0xFF, 0xFF,		// RX_OFFSET (low), TX_OFFSET (high), TX_OFFSET (low), INITIAL_I2C_TIMEOUT
+	0xFF, 0x07, 0x00, 0x00,		// RECURRING_I2C_TIMEOUT, DEBUG_REG, RESET, (reserved)
+	0x0F, 0x1F, 0xFF, 0xFF,		// TRANSPARENT_MODE, ALMOST_EMPTY_THRESHOLD (high), ALMOST_EMPTY_THRESHOLD (low), PTT_OFF_DELAY_AFSK
+	0xFF						// PTT_OFF_DELAY_GMSK
+};
+
+template <class Bus>
+UHF_Transceiver<Bus>::UHF_Transceiver(bool debug, uint8_t bus) : i2c(bus, TRANSCEIVER_I2C_ADDR) {
 	this->debug = debug;
-	i2c = I2C_Functions(bus, TRANSCEIVER_I2C_ADDR);
+	shadow_valid = 0;
+	shadow_written = 0;
+	beacon_len = 0;
+	beacon_valid = false;
+	tx_free = 0;
+	tx_capacity = 0;
+	tx_low_water = 0;
+	tx_line_bps = TX_AFSK_BPS;
+	tx_overrun_base = 0;
+	tx_streaming = false;
+	tx_stats = {0, 0, 0, 0, 0, 0};
+}
+
+/*********************** Shadow Registers **********************/
+
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::readShadow(uint8_t reg) {
+	if (!(shadow_valid & (1UL << reg))) {
+		/* a failed read is not cached: the register stays unknown and is read again next time */
+		uint8_t data;
+		if (!i2c.readn(reg, 1, &data)) return 0;
+		shadow[reg] = data & config_mask[reg];
+		shadow_valid |= (1UL << reg);
+	}
+	return shadow[reg];
+}
+
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::readShadow2(uint8_t reg) {
+	if ((shadow_valid & (3UL << reg)) != (3UL << reg)) {
+		uint8_t data[2];
+		if (!i2c.readn(reg, 2, data)) return 0;
+		shadow[reg] = data[0] & config_mask[reg];
+		shadow[reg+1] = data[1] & config_mask[reg+1];
+		shadow_valid |= (3UL << reg);
+	}
+	return (((uint16_t)shadow[reg])<<8) | ((uint16_t)shadow[reg+1]);		// big endian, as in I2C_Functions
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::writeShadow(uint8_t reg, uint8_t data) {
+	i2c.write(reg, data);
+	shadow[reg] = data & config_mask[reg];
+	shadow_valid |= (1UL << reg);
+	shadow_written |= (1UL << reg);
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::writeShadow2(uint8_t reg, uint16_t data) {
+	i2c.write2(reg, data);
+	shadow[reg] = ((data >> 8) & 0xFF) & config_mask[reg];
+	shadow[reg+1] = (data & 0xFF) & config_mask[reg+1];
+	shadow_valid |= (3UL << reg);
+	shadow_written |= (3UL << reg);
+}
+
+/*********************** Register Access **********************/
+
+/* a shadowed register must mirror exactly the bits its descriptor says it has */
+template <class Reg>
+constexpr bool shadow_mask_agrees() {
+	if (!Reg::shadowed) return true;
+	if (Reg::width == 1) return config_mask[Reg::addr] == Reg::mask;
+	return ((config_mask[Reg::addr] << 8) | config_mask[Reg::addr + 1]) == Reg::mask;
+}
+
+template <class Bus>
+template <class Reg>
+uint16_t UHF_Transceiver<Bus>::readReg() {
+	static_assert(Reg::readable, "the register is write-only");
+	static_assert(shadow_mask_agrees<Reg>(), "the descriptor and the shadow copy disagree on the register's bits");
+
+	if constexpr (Reg::shadowed) {
+		return ((Reg::width == 2) ? readShadow2(Reg::addr) : readShadow(Reg::addr)) & Reg::mask;
+	} else {
+		return ((Reg::width == 2) ? i2c.read2(Reg::addr) : i2c.read(Reg::addr)) & Reg::mask;
+	}
 }
 
-uint8_t UHF_Transceiver::getModemConfig() {
-	uint8_t config = i2c.read(MODEM_CONFIG);
-	config &= 0b11;
+template <class Bus>
+template <class Reg>
+void UHF_Transceiver<Bus>::writeReg(uint16_t data) {
+	static_assert(Reg::writable, "the register is read-only");
+	static_assert(shadow_mask_agrees<Reg>(), "the descriptor and the shadow copy disagree on the register's bits");
+
+	if constexpr (Reg::shadowed) {
+		if constexpr (Reg::width == 2) writeShadow2(Reg::addr, data);
+		else 						   writeShadow(Reg::addr, data);
+	} else {
+		if constexpr (Reg::width == 2) i2c.write2(Reg::addr, data);
+		else 						   i2c.write(Reg::addr, data);
+	}
+}
 
-	std::string out_str = "Modulation Scheme: ";
+template <class Bus>
+template <class Reg>
+float UHF_Transceiver<Bus>::readConv() {
+	static_assert(Reg::channel != CONV_RAW, "the register holds no sensor reading");
+	return conv(Reg::channel, readReg<Reg>());
+}
+
+/* queues a burst on a batch; reading a write-only register or writing a read-only one does not compile */
+template <class Burst>
+static int batch_read(I2C_Batch* batch) {
+	static_assert(Burst::readable, "the burst includes a write-only register");
+	return batch->read(Burst::addr, Burst::len);
+}
 
-	if      (config == MODEM_GMSK_DOWN) out_str += "9600 bps GMSK downlink, 1200 bps AFSK uplink.";
-	else if (config == MODEM_GMSK_UP)   out_str += "1200 bps AFSK downlink, 9600 bps GMSK uplink.";
-	else if (config == MODEM_GMSK_BOTH) out_str += "9600 bps GMSK downlink and uplink.";
+template <class Burst>
+static int batch_write(I2C_Batch* batch, const uint8_t* image) {
+	static_assert(Burst::writable, "the burst includes a read-only register");
+	return batch->writen(Burst::addr, &image[Burst::addr], Burst::len);
+}
+
+/* the runs of consecutive configuration registers between the FIFO and reset registers */
+using config_modem_t = urtx_burst_t<reg_modem_config, reg_ax25_tx_delay, reg_sync_bytes>;
+using config_beacon_t = urtx_burst_t<reg_beacon_ctrl>;
+using config_rf_t = urtx_burst_t<reg_pa_power_lvl, reg_rx_offset, reg_tx_offset, reg_initial_i2c_timeout, reg_recurring_i2c_timeout>;
+using config_rf_debug_t = urtx_burst_t<reg_pa_power_lvl, reg_rx_offset, reg_tx_offset, reg_initial_i2c_timeout, reg_recurring_i2c_timeout, reg_debug>;
+using config_mode_t = urtx_burst_t<reg_transparent_mode, reg_almost_empty_threshold>;
+using config_mode_ptt_t = urtx_burst_t<reg_transparent_mode, reg_almost_empty_threshold, reg_ptt_off_delay_afsk, reg_ptt_off_delay_gmsk>;
+
+static_assert(config_mode_ptt_t::addr + config_mode_ptt_t::len == CONFIG_BLOCK_LEN, "the readback must cover the configuration block");
+
+template <class Bus>
+int UHF_Transceiver<Bus>::readConfigBlock(uint8_t* actual) {
+	/* one transaction reads back the whole configuration block, skipping the FIFO and reset registers */
+	I2C_Batch readback;
+	int block_a = batch_read<config_modem_t>(&readback);
+	int block_b = batch_read<config_beacon_t>(&readback);
+	int block_c = batch_read<config_rf_debug_t>(&readback);
+	int block_d = batch_read<config_mode_ptt_t>(&readback);
+	if (i2c.execute(&readback) < 0) {
+		LOG_ERROR("Unable to read back the configuration registers.");
+		return -1;
+	}
+
+	memset(actual, 0, CONFIG_BLOCK_LEN);
+	memcpy(&actual[config_modem_t::addr], readback.getn(block_a), config_modem_t::len);
+	memcpy(&actual[config_beacon_t::addr], readback.getn(block_b), config_beacon_t::len);
+	memcpy(&actual[config_rf_debug_t::addr], readback.getn(block_c), config_rf_debug_t::len);
+	memcpy(&actual[config_mode_ptt_t::addr], readback.getn(block_d), config_mode_ptt_t::len);
+	return 0;
+}
+
+template <class Bus>
+int UHF_Transceiver<Bus>::repairConfig() {
+	I2C_PROFILE_SCOPE();
+	uint8_t actual[CONFIG_BLOCK_LEN];
+	if (readConfigBlock(actual) < 0) return -1;
+
+	/* rewrite only the registers that drifted away from what was last written (one that was only read has nothing to restore) */
+	I2C_Batch rewrite;
+	for (int reg = 0; reg < CONFIG_BLOCK_LEN; reg++) {
+		if (!config_mask[reg] || !(shadow_written & (1UL << reg))) continue;
+		if ((actual[reg] & config_mask[reg]) == shadow[reg]) continue;
+
+		LOG_WARN("Register %d drifted, restoring it.", reg);
+		rewrite.write(reg, (actual[reg] & ~config_mask[reg]) | shadow[reg]);
+	}
+	if (rewrite.size()) beacon_valid = false;				// drift usually means a reset, which also empties the beacon
+
+	if (rewrite.size() && i2c.execute(&rewrite) < 0) return -1;
+	return rewrite.size();
+}
+
+template <class Bus>
+int UHF_Transceiver<Bus>::applyProfile(const urtx_profile_t& profile) {
+	I2C_PROFILE_SCOPE();
+	if (profile.rx_freq > 440 || profile.rx_freq < 430 || profile.tx_freq > 440 || profile.tx_freq < 430) {
+		LOG_ERROR("The startup frequencies are outside of the bounds of 430 MHz and 440 MHz.");
+		return -1;
+	}
+
+	/* the register image, laid out as the configuration block */
+	uint8_t image[CONFIG_BLOCK_LEN];
+	uint16_t rx_offset = (uint16_t)((profile.rx_freq - 430) * 80);						// pp. 22
+	uint16_t tx_offset = (uint16_t)((profile.tx_freq - 430) * 40);						// pp. 22
+	uint16_t threshold = low_water(profile.modem_config);
+
+	image[MODEM_CONFIG] = profile.modem_config;
+	image[PA_POWER_LVL] = profile.pa_power;
+	image[RX_OFFSET] = rx_offset >> 8;
+	image[RX_OFFSET+1] = rx_offset & 0xFF;
+	image[TX_OFFSET] = tx_offset >> 8;
+	image[TX_OFFSET+1] = tx_offset & 0xFF;
+	image[INITIAL_I2C_TIMEOUT] = profile.initial_timeout;
+	image[RECURRING_I2C_TIMEOUT] = profile.recurring_timeout;
+	image[TRANSPARENT_MODE] = profile.mode;
+	image[ALMOST_EMPTY_THRESHOLD] = threshold >> 8;
+	image[ALMOST_EMPTY_THRESHOLD+1] = threshold & 0xFF;
+
+	/* three runs of consecutive registers, written in a single transaction */
+	I2C_Batch load;
+	batch_write<urtx_burst_t<reg_modem_config>>(&load, image);
+	batch_write<config_rf_t>(&load, image);
+	batch_write<config_mode_t>(&load, image);
+	if (i2c.execute(&load) < 0) {
+		LOG_ERROR("Unable to write the startup profile.");
+		return -1;
+	}
+
+	/* one readback verifies the profile and fills in the shadow copy; written registers keep the value intended,
+	   so a mismatch is rewritten by the next repairConfig() */
+	uint8_t actual[CONFIG_BLOCK_LEN];
+	if (readConfigBlock(actual) < 0) return -1;
+
+	int mismatches = 0;
+	for (int reg = 0; reg < CONFIG_BLOCK_LEN; reg++) {
+		if (!config_mask[reg]) continue;
+		bool written = (reg == MODEM_CONFIG) || config_rf_t::covers(reg) || config_mode_t::covers(reg);
+		if (written && (actual[reg] & config_mask[reg]) != (image[reg] & config_mask[reg])) {
+			LOG_ERROR("Register %d reads back 0x%02X instead of 0x%02X.", reg, actual[reg], image[reg]);
+			mismatches++;
+		}
+		shadow[reg] = (written ? image[reg] : actual[reg]) & config_mask[reg];
+		shadow_valid |= (1UL << reg);
+		if (written) shadow_written |= (1UL << reg);
+	}
+	return mismatches ? -1 : 0;
+}
+
+template <class Bus>
+int UHF_Transceiver<Bus>::waitForLock(uint32_t timeout_ms) {
+	I2C_PROFILE_SCOPE();
+	auto start = std::chrono::steady_clock::now();
+	uint32_t waited_us = 0, backoff_us = LOCK_POLL_MIN_US;
+
+	/* the waits are counted rather than timed, so a simulated bus (whose clock only moves when told) agrees */
+	while (!testLocks()) {
+		if (waited_us >= timeout_ms * 1000) {
+			LOG_ERROR("No frequency lock after %u ms.", (unsigned)timeout_ms);
+			return -1;
+		}
+		i2c.idle(backoff_us);
+		waited_us += backoff_us;
+		backoff_us = (backoff_us * 2 < LOCK_POLL_MAX_US) ? backoff_us * 2 : LOCK_POLL_MAX_US;
+	}
+
+	/* on hardware the clock also covers the polls; on a simulated bus only the counted waits have passed */
+	uint32_t elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	return (waited_us / 1000 > elapsed_ms) ? waited_us / 1000 : elapsed_ms;
+}
+
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getModemConfig() {
+	I2C_PROFILE_SCOPE();
+	uint8_t config = readReg<reg_modem_config>();
+
+	const char* out_str = "";
+
+	if      (config == MODEM_GMSK_DOWN) out_str = "9600 bps GMSK downlink, 1200 bps AFSK uplink.";
+	else if (config == MODEM_GMSK_UP)   out_str = "1200 bps AFSK downlink, 9600 bps GMSK uplink.";
+	else if (config == MODEM_GMSK_BOTH) out_str = "9600 bps GMSK downlink and uplink.";
 	else {
-		printe("There was an error in the reception of the data.");
+		LOG_ERROR("There was an error in the reception of the data.");
 		return 0;
 	}
 
-	printi(out_str);
+	UHF_INFO("Modulation Scheme: %s", out_str);
 	return config;
 }
 
-void UHF_Transceiver::setModemConfig(uint8_t config) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setModemConfig(uint8_t config) {
+	I2C_PROFILE_SCOPE();
 	uint8_t command;
 
-	std::string out_str = "Modulation scheme switched to: ";
+	const char* out_str = "";
 
 	switch (config) {
 		case MODEM_GMSK_DOWN:  
-			out_str += "9600 bps GMSK downlink, 1200 bps AFSK uplink.";
+			out_str = "9600 bps GMSK downlink, 1200 bps AFSK uplink.";
 			command = config;
 			break;
 		case MODEM_GMSK_UP: 
-			out_str += "1200 bps AFSK downlink, 9600 bps GMSK uplink.";
+			out_str = "1200 bps AFSK downlink, 9600 bps GMSK uplink.";
 			command = config; 
 			break;
 		case MODEM_GMSK_BOTH: 
-			out_str += "9600 bps GMSK downlink and uplink.";
+			out_str = "9600 bps GMSK downlink and uplink.";
 			command = config; 
 			break;
 		default: 
-			printe("Modulation scheme was not appropriate.");
+			LOG_ERROR("Modulation scheme was not appropriate.");
 			return;
 	}
 
-	i2c.write(MODEM_CONFIG, command);
-	printi(out_str);
+	writeReg<reg_modem_config>(command);
+	UHF_INFO("Modulation scheme switched to: %s", out_str);
 }
 
-void UHF_Transceiver::setTransmissionDelay(uint8_t delay) {
-	i2c.write(AX25_TX_DELAY, delay);
+template <class Bus>
+void UHF_Transceiver<Bus>::setTransmissionDelay(uint8_t delay) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_ax25_tx_delay>(delay);
 }
 
-uint8_t UHF_Transceiver::getTransmissionDelay() {
-	return i2c.read(AX25_TX_DELAY);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getTransmissionDelay() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_ax25_tx_delay>();
 }
 
-void UHF_Transceiver::setSyncBytes(uint8_t val) {
-	i2c.write(SYNC_BYTES, val);
+template <class Bus>
+void UHF_Transceiver<Bus>::setSyncBytes(uint8_t val) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_sync_bytes>(val);
 }
 
-uint8_t UHF_Transceiver::getSyncBytes() {
-	return i2c.read(SYNC_BYTES);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getSyncBytes() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_sync_bytes>();
 }
 
-void UHF_Transceiver::sendByte(uint8_t data) {
-	while(!transmitReady());
-	i2c.write(TX_DATA, data);
+template <class Bus>
+int UHF_Transceiver<Bus>::waitTransmitReady() {
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READY_TIMEOUT_MS);
+	while (!transmitReady()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			LOG_ERROR("Timed out waiting for the transmitter.");
+			return -1;
+		}
+	}
+	return 0;
 }
 
-void UHF_Transceiver::sendNBytes(uint8_t* data, int n) {
-	while(!transmitReady());
-	i2c.writen(TX_DATA, data, n);
+template <class Bus>
+int UHF_Transceiver<Bus>::waitReceiveReady() {
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READY_TIMEOUT_MS);
+	while (!receiveReady()) {
+		if (std::chrono::steady_clock::now() > deadline) {
+			LOG_ERROR("Timed out waiting for the receiver.");
+			return -1;
+		}
+	}
+	return 0;
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::sendByte(uint8_t data) {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	if (waitTransmitReady() < 0) return;
+	writeReg<reg_tx_data>(data);
+}
+
+template <class Bus>
+int UHF_Transceiver<Bus>::sendNBytes(const uint8_t* data, int n) {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READY_TIMEOUT_MS);
+	int sent = 0;
+
+	while (sent < n) {
+		int wanted = (n - sent < TX_MIN_BURST) ? n - sent : TX_MIN_BURST;
+
+		/* the free slot count is only read again once the bytes known to fit have been used up */
+		if (tx_free < wanted) {
+			refreshTxFreeSlots();
+			if (tx_free < wanted) {
+				if (std::chrono::steady_clock::now() > deadline) {
+					LOG_ERROR("Timed out waiting for the transmitter.");
+					return -1;
+				}
+				/* sleep until the modem has drained the FIFO down to the almost-empty threshold */
+				uint32_t queued = tx_capacity - tx_free;
+				uint32_t drain = (queued > tx_low_water) ? queued - tx_low_water : wanted - tx_free;
+				i2c.idle(drain * 8 * 1000000ULL / tx_line_bps);
+				tx_stats.waits++;
+				continue;
+			}
+		}
+
+		/* TX_DATA is a FIFO, so the burst is bounded by the free slots and the longest transaction */
+		int len = (n - sent < tx_free) ? n - sent : tx_free;
+		if (len > I2C_MAX_TRANSFER_LEN) len = I2C_MAX_TRANSFER_LEN;
+		/* a failed burst may have partly reached the FIFO, so it is not replayed: the frame is reported as failed */
+		if (i2c.writen(TX_DATA, &data[sent], len, false) < 0) return -1;
+
+		tx_free -= len;
+		sent += len;
+		tx_streaming = true;
+		tx_stats.bytes += len;
+		tx_stats.bursts++;
+		deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(READY_TIMEOUT_MS);
+	}
+	return 0;
 }
 
-void UHF_Transceiver::sendString(const std::string &data, uint8_t n) {
-	char* data_arr = new char[n+1];
-	 for (int i = 0; i < n; i++) {
-	 	data_arr[i] = data.at(i);
-	 }
-	uint8_t* data_out = (uint8_t*)data_arr;
-	sendNBytes(data_out, n);
+template <class Bus>
+void UHF_Transceiver<Bus>::refreshTxFreeSlots() {
+	tx_free = getTxFreeSlots();
+	tx_stats.slot_reads++;
+
+	/* an empty FIFO while a stream is open means the modem ran out of data between bursts */
+	if (tx_free >= tx_capacity) {
+		if (tx_streaming && tx_capacity) tx_stats.underruns++;
+		tx_capacity = tx_free;
+	}
+}
 
-	delete[] data_arr;
+template <class Bus>
+int UHF_Transceiver<Bus>::configureTxStream() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	tx_streaming = false;
+	tx_capacity = 0;
+	refreshTxFreeSlots();									// nothing has been queued yet, so every slot is free
+	if (tx_capacity == 0) {
+		LOG_ERROR("Unable to size the transmit buffer.");
+		return -1;
+	}
+
+	uint8_t modem_config = readReg<reg_modem_config>();
+	tx_line_bps = line_rate(modem_config);
+	tx_low_water = low_water(modem_config);
+	if (getTxThreshold() != tx_low_water) setTxThreshold(tx_low_water);		// normally already written by the startup profile
+
+	tx_overrun_base = getTxBufferOverrunCnt();
+	tx_stats = {0, 0, 0, 0, 0, 0};
+	UHF_INFO("Tx Stream: %d byte FIFO, almost empty below %d bytes", tx_capacity, tx_low_water);
+	return 0;
 }
 
-uint8_t UHF_Transceiver::getBeaconCtrl() {
-	uint8_t status = i2c.read(BEACON_CTRL);
-	std::string out_str = "Beacon Status: ";
+template <class Bus>
+void UHF_Transceiver<Bus>::endTxStream() {
+	tx_streaming = false;
+}
 
-	if (BIT_VAL(status, 0))  out_str += "Beacon is currently enabled.";
-					    else out_str += "Beacon is currently disabled.";
+template <class Bus>
+const tx_stats_t& UHF_Transceiver<Bus>::getTxStats() {
+	tx_stats.overruns = (uint16_t)(getTxBufferOverrunCnt() - tx_overrun_base);
+	return tx_stats;
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::sendString(const std::string &data, int n) {
+	I2C_PROFILE_SCOPE();
+	if (n > (int)data.length()) n = data.length();
+	sendNBytes((const uint8_t*)data.data(), n);
+}
 
-	printi(out_str);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getBeaconCtrl() {
+	I2C_PROFILE_SCOPE();
+	uint8_t status = readReg<reg_beacon_ctrl>();
+	const char* out_str = "";
+
+	if (BIT_VAL(status, 0))  out_str = "Beacon is currently enabled.";
+					    else out_str = "Beacon is currently disabled.";
+
+	UHF_INFO("Beacon Status: %s", out_str);
 	return status;
 }
 
-void UHF_Transceiver::clearBeaconData() {
+template <class Bus>
+void UHF_Transceiver<Bus>::clearBeaconData() {
+	I2C_PROFILE_SCOPE();
 	uint8_t status = getBeaconCtrl();
 	uint8_t config = BIT_SET(status, 1);
-	i2c.write(BEACON_CTRL, config);				// automatically cleared after data is cleared
+	writeReg<reg_beacon_ctrl>(config);				// automatically cleared after data is cleared
+	beacon_len = 0;
+	beacon_valid = true;
 }
 
-void UHF_Transceiver::beaconEnable(bool enable) {
+template <class Bus>
+void UHF_Transceiver<Bus>::beaconEnable(bool enable) {
+	I2C_PROFILE_SCOPE();
 	uint8_t status = getBeaconCtrl();
 	uint8_t config; 
 
 	if (enable) config = BIT_SET(status, 0);
 	else 	    config = BIT_CLEAR(status, 0);
 
-	i2c.write(BEACON_CTRL, config);
+	writeReg<reg_beacon_ctrl>(config);
 }
 
-void UHF_Transceiver::enableBeacon() {
+template <class Bus>
+void UHF_Transceiver<Bus>::enableBeacon() {
+	I2C_PROFILE_SCOPE();
 	beaconEnable(true);
 }
 
-void UHF_Transceiver::disableBeacon() {
+template <class Bus>
+void UHF_Transceiver<Bus>::disableBeacon() {
+	I2C_PROFILE_SCOPE();
 	beaconEnable(false);
 }
 
-void UHF_Transceiver::setBeaconData(uint8_t data) {
-	i2c.write(BEACON_DATA, data);
+template <class Bus>
+void UHF_Transceiver<Bus>::setBeaconData(uint8_t data) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_beacon_data>(data);
+	beacon_valid = false;
 }
 
-void UHF_Transceiver::setBeaconOutput(std::string str) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setBeaconOutput(const std::string& str) {
+	I2C_PROFILE_SCOPE();
 	int str_len = str.length();
-	if (str_len > BEACON_DATA_BUFFER_LEN) {
-		str = str.substr(0, BEACON_DATA_BUFFER_LEN);
+	if (str_len > BEACON_DATA_BUFFER_LEN) str_len = BEACON_DATA_BUFFER_LEN;
+	const uint8_t* data = (const uint8_t*)str.data();
+
+	/* the beacon is refreshed every scan, but its contents rarely change */
+	if (beacon_valid && beacon_len == str_len && !memcmp(beacon, data, str_len)) return;
+
+	/* clear (self-clearing bit) and reload the buffer in a single transaction */
+	I2C_Batch load;
+	load.write(BEACON_CTRL, readReg<reg_beacon_ctrl>() | 0x02);
+	load.writen(BEACON_DATA, data, str_len);
+	if (i2c.execute(&load) < 0) {
+		LOG_ERROR("Unable to load the beacon buffer.");
+		beacon_valid = false;
+		return;
 	}
 
-    clearBeaconData();
-	for (int i = 0; i < str_len; i++) {
-		setBeaconData(str.at(i));
-	}
+	memcpy(beacon, data, str_len);
+	beacon_len = str_len;
+	beacon_valid = true;
 }
 
-uint8_t UHF_Transceiver::getPAPower() {
-	uint8_t power = i2c.read(PA_POWER_LVL);
-	power &= 0b11;
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getPAPower() {
+	I2C_PROFILE_SCOPE();
+	uint8_t power = readReg<reg_pa_power_lvl>();
 
-	std::string out_str = "Power Amplifier Power Level: ";
+	const char* out_str = "";
 
-	if      (power == PA_LVL_27) out_str+= "27 dBm (0.5 W).";
-	else if (power == PA_LVL_30) out_str += "30 dBm (1 W).";
-	else if (power == PA_LVL_33) out_str += "33 dBm (2 W).";
-	else 	  			 	out_str += "Inhibit (0 dBm/W).";
+	if      (power == PA_LVL_27) out_str = "27 dBm (0.5 W).";
+	else if (power == PA_LVL_30) out_str = "30 dBm (1 W).";
+	else if (power == PA_LVL_33) out_str = "33 dBm (2 W).";
+	else 	  			 	out_str = "Inhibit (0 dBm/W).";
 
-	printi(out_str);
+	UHF_INFO("Power Amplifier Power Level: %s", out_str);
 	return power;
 }
 
-void UHF_Transceiver::setPAPower(uint8_t config) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setPAPower(uint8_t config) {
+	I2C_PROFILE_SCOPE();
 	uint8_t command;
 
-	std::string out_str = "Power Amplifier power level switched to: ";
+	const char* out_str = "";
 
 	switch (config) {
 		case PA_LVL_27: 
-			out_str += "27 dBm (0.5 W).";
+			out_str = "27 dBm (0.5 W).";
 			command = PA_LVL_27; 
 			break;
 		case PA_LVL_30: 
-			out_str += "30 dBm (1 W).";
+			out_str = "30 dBm (1 W).";
 			command = PA_LVL_30; 
 			break;
 		case PA_LVL_33: 
-			out_str += "33 dBm (2 W).";
+			out_str = "33 dBm (2 W).";
 			command = PA_LVL_33; 
 			break;
 		case PA_LVL_INHIBIT:
-			out_str += "Inhibit (0 dBm/W).";
+			out_str = "Inhibit (0 dBm/W).";
 			command = PA_LVL_INHIBIT; 
+			break;
 		default: 
-			printe("Modulation scheme was not appropriate.");
+			LOG_ERROR("Modulation scheme was not appropriate.");
 			return;
 	}
 
-	i2c.write(PA_POWER_LVL, command);
-	printi(out_str);
+	writeReg<reg_pa_power_lvl>(command);
+	UHF_INFO("Power Amplifier power level switched to: %s", out_str);
 }
 
-uint16_t UHF_Transceiver::getRxFreqOffset() {
-	uint16_t offset = i2c.read2(RX_OFFSET);
-	offset &= 0x3FF;
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getRxFreqOffset() {
+	I2C_PROFILE_SCOPE();
+	uint16_t offset = readReg<reg_rx_offset>();
 	return offset;
 }
 
-void UHF_Transceiver::setRxFreqOffset(uint16_t offset) {
-	printf("Frequency Offset: %d\n", offset);
+template <class Bus>
+void UHF_Transceiver<Bus>::setRxFreqOffset(uint16_t offset) {
+	I2C_PROFILE_SCOPE();
+	UHF_INFO("Frequency Offset: %d", offset);
 	if (offset > 1023) {
-		printe("Rx frequency offset is larger than 1023.");
+		LOG_ERROR("Rx frequency offset is larger than 1023.");
 	}
-	i2c.write2(RX_OFFSET, offset);
+	writeReg<reg_rx_offset>(offset);
 }
 
-void UHF_Transceiver::setRxFreq(float freq) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setRxFreq(float freq) {
+	I2C_PROFILE_SCOPE();
 	if (freq > 440 || freq < 430) {
-		printe("The desired receiving frequency is outside of the bounds of 430 MHHz and 440 MHz.");
+		LOG_ERROR("The desired receiving frequency is outside of the bounds of 430 MHHz and 440 MHz.");
 	}
 	uint16_t offset = (uint16_t)((freq - 430) * 80);									// pp. 22
 	setRxFreqOffset(offset);
 }
 
-float UHF_Transceiver::getRxFreq() {
+template <class Bus>
+float UHF_Transceiver<Bus>::getRxFreq() {
+	I2C_PROFILE_SCOPE();
 	uint16_t offset = getRxFreqOffset();
 	float freq = (offset * 0.0125) + 430;												// pp. 22
 	return freq;
 }
 
-uint16_t UHF_Transceiver::getTxFreqOffset() {
-	uint16_t offset = i2c.read2(TX_OFFSET);
-	offset &= 0x1FF;
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getTxFreqOffset() {
+	I2C_PROFILE_SCOPE();
+	uint16_t offset = readReg<reg_tx_offset>();
 	return offset;
 }
 
-void UHF_Transceiver::setTxFreqOffset(uint16_t offset) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setTxFreqOffset(uint16_t offset) {
+	I2C_PROFILE_SCOPE();
 	if (offset > 511) {
-		printe("Tx frequency offset is larger than 511.");
+		LOG_ERROR("Tx frequency offset is larger than 511.");
 	}
-	i2c.write2(TX_OFFSET, offset);
+	writeReg<reg_tx_offset>(offset);
 }
 
-void UHF_Transceiver::setTxFreq(float freq) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setTxFreq(float freq) {
+	I2C_PROFILE_SCOPE();
 	if (freq > 440 || freq < 430) {
-		printe("The desired transmission frequency is outside of the bounds of 430 MHHz and 440 MHz.");
+		LOG_ERROR("The desired transmission frequency is outside of the bounds of 430 MHHz and 440 MHz.");
 	}
 	uint16_t offset = (uint16_t)((freq - 430) * 40);									// pp. 22
 	setTxFreqOffset(offset);
 }
 
-float UHF_Transceiver::getTxFreq() {
+template <class Bus>
+float UHF_Transceiver<Bus>::getTxFreq() {
+	I2C_PROFILE_SCOPE();
 	uint16_t offset = getTxFreqOffset();
 	float freq = (offset * 0.025) + 430;												// pp. 22
 	return freq;
 }
 
-void UHF_Transceiver::setInitialTimeout(uint8_t timeout) {
-	i2c.write(INITIAL_I2C_TIMEOUT, timeout);
+template <class Bus>
+void UHF_Transceiver<Bus>::setInitialTimeout(uint8_t timeout) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_initial_i2c_timeout>(timeout);
 }
 
-uint8_t UHF_Transceiver::getInitialTimeout() {
-	return i2c.read(INITIAL_I2C_TIMEOUT);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getInitialTimeout() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_initial_i2c_timeout>();
 }
 
-void UHF_Transceiver::setRecurringTimeout(uint8_t timeout) {
-	i2c.write(RECURRING_I2C_TIMEOUT, timeout);
+template <class Bus>
+void UHF_Transceiver<Bus>::setRecurringTimeout(uint8_t timeout) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_recurring_i2c_timeout>(timeout);
 }
 
-uint8_t UHF_Transceiver::getRecurringTimeout() {
-	return i2c.read(RECURRING_I2C_TIMEOUT);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getRecurringTimeout() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_recurring_i2c_timeout>();
 }
 
-uint8_t UHF_Transceiver::getDebug() {
-	uint8_t status = i2c.read(DEBUG_REG);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getDebug() {
+	I2C_PROFILE_SCOPE();
+	uint8_t status = readReg<reg_debug>();
 	status &= 0x07;
 
-	std::string out_str = "Debug Status:\n";
-
-	if (BIT_VAL(status, 2)) out_str += "\tThe lock status of the receive and transmit synthesizers is ENABLED.\n";
-					   else out_str += "\tThe lock status of the receive and transmit synthesizers is DISABLED.\n";
-	if (BIT_VAL(status, 1)) out_str += "\tLED 1 is ON.\n";
-					   else out_str += "\tLED 1 is OFF.\n";
-	if (BIT_VAL(status, 0)) out_str += "\tLED 0 is ON.";
-					   else out_str += "\tLED 0 is OFF.";
-
-	printi(out_str);
+	UHF_INFO("Debug Status: synthesizer lock status %s, LED 1 %s, LED 0 %s.",
+			 BIT_VAL(status, 2) ? "ENABLED" : "DISABLED", BIT_VAL(status, 1) ? "ON" : "OFF", BIT_VAL(status, 0) ? "ON" : "OFF");
 	return status;
 }
 
-void UHF_Transceiver::ledOn(int led) {
+template <class Bus>
+void UHF_Transceiver<Bus>::ledOn(int led) {
+	I2C_PROFILE_SCOPE();
 	if (led == 1 || led == 0) {
 		uint8_t status = getDebug();
 		BIT_SET(status, led);
-		i2c.write(DEBUG_REG, status);
+		writeReg<reg_debug>(status);
 		return;
 	}
-	printe("Invalid LED.");
+	LOG_ERROR("Invalid LED.");
 }
 
-void UHF_Transceiver::ledOff(int led) {
+template <class Bus>
+void UHF_Transceiver<Bus>::ledOff(int led) {
+	I2C_PROFILE_SCOPE();
 	if (led == 1 || led == 0) {
 		uint8_t status = getDebug();
 		BIT_CLEAR(status, led);
-		i2c.write(DEBUG_REG, status);
+		writeReg<reg_debug>(status);
 		return;
 	}
-	printe("Invalid LED.");
+	LOG_ERROR("Invalid LED.");
 }
 
-void UHF_Transceiver::ledToggle(int led) {
+template <class Bus>
+void UHF_Transceiver<Bus>::ledToggle(int led) {
+	I2C_PROFILE_SCOPE();
 	if (led == 1 || led == 0) {
 		uint8_t status = getDebug();
 		status = BIT_TOGGLE(status, led);
-		i2c.write(DEBUG_REG, status);
+		writeReg<reg_debug>(status);
 		return;
 	}
-	printe("Invalid LED.");
+	LOG_ERROR("Invalid LED.");
 }
 
-void UHF_Transceiver::reset() {
-	i2c.write(RESET, 0x00);
+template <class Bus>
+void UHF_Transceiver<Bus>::reset() {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_reset>(0x00);
+	shadow_valid = 0;										// every register is back to its default
+	shadow_written = 0;
+	beacon_valid = false;
+	tx_streaming = false;									// the FIFO was cleared, not starved
 }
 
-uint8_t UHF_Transceiver::getMode() {
-	uint8_t config = i2c.read(TRANSPARENT_MODE);
-	config &= 0xF;
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getMode() {
+	I2C_PROFILE_SCOPE();
+	uint8_t config = readReg<reg_transparent_mode>();
 
-	std::string out_str = "Operation Mode: ";
+	const char* out_str = "";
 
-	if      (config == AX25_MODE)               out_str += "AX.25.";
-	else if (config == TRANS_MODE_CONV_ENABLE)  out_str += "Transparent: convolutional encoder enabled.";
-	else if (config == TRANS_MODE_CONV_DISABLE) out_str += "Transparent: convolutional encoder disabled.";
-	else					                    out_str += "ERROR: There was an error in the reception of the data.";
+	if      (config == AX25_MODE)               out_str = "AX.25.";
+	else if (config == TRANS_MODE_CONV_ENABLE)  out_str = "Transparent: convolutional encoder enabled.";
+	else if (config == TRANS_MODE_CONV_DISABLE) out_str = "Transparent: convolutional encoder disabled.";
+	else					                    out_str = "ERROR: There was an error in the reception of the data.";
 
-	printi(out_str);
+	UHF_INFO("Operation Mode: %s", out_str);
 	return config;
 }
 
-void UHF_Transceiver::setMode(uint8_t config) {
-	std::string out_str = "Operation Mode set to: ";
+template <class Bus>
+void UHF_Transceiver<Bus>::setMode(uint8_t config) {
+	I2C_PROFILE_SCOPE();
+	const char* out_str = "";
 
 	switch (config) {
 		case AX25_MODE: 
-			out_str += "AX.25.";
+			out_str = "AX.25.";
 			break;
 		case TRANS_MODE_CONV_ENABLE: 
-			out_str += "Transparent: convolutional encoder enabled.";
+			out_str = "Transparent: convolutional encoder enabled.";
 			break;
 		case TRANS_MODE_CONV_DISABLE: 
-			out_str += "Transparent: convolutional encoder disabled.";
+			out_str = "Transparent: convolutional encoder disabled.";
 			break;
 		default: 
-			printe("Selected operation mode was not appropriate.");
+			LOG_ERROR("Selected operation mode was not appropriate.");
 			return;
 	}
 
-	i2c.write(TRANSPARENT_MODE, config);
-	printi(out_str);
+	writeReg<reg_transparent_mode>(config);
+	UHF_INFO("Operation Mode set to: %s", out_str);
 }
 
-uint16_t UHF_Transceiver::getTxThreshold() {
-	return i2c.read2(ALMOST_EMPTY_THRESHOLD);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getTxThreshold() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_almost_empty_threshold>();
 }
 
-void UHF_Transceiver::setTxThreshold(uint16_t threshold) {
+template <class Bus>
+void UHF_Transceiver<Bus>::setTxThreshold(uint16_t threshold) {
+	I2C_PROFILE_SCOPE();
 	if (threshold > 8191) {
-		printe("The desired transmit ready threshold must be less than 8191.");
+		LOG_ERROR("The desired transmit ready threshold must be less than 8191.");
 		return;
 	}
 
-	i2c.write2(ALMOST_EMPTY_THRESHOLD, threshold);
+	writeReg<reg_almost_empty_threshold>(threshold);
 }
 
-uint8_t UHF_Transceiver::getPAOffDelayGMSK() {
-	return i2c.read(PTT_OFF_DELAY_GMSK);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getPAOffDelayGMSK() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_ptt_off_delay_gmsk>();
 }
 
-void UHF_Transceiver::setPAOffDelayGMSK(uint8_t delay) {
-	i2c.write(PTT_OFF_DELAY_GMSK, delay);
+template <class Bus>
+void UHF_Transceiver<Bus>::setPAOffDelayGMSK(uint8_t delay) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_ptt_off_delay_gmsk>(delay);
 }
 
-uint8_t UHF_Transceiver::getPAOffDelayAFSK() {
-	return i2c.read(PTT_OFF_DELAY_AFSK);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getPAOffDelayAFSK() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_ptt_off_delay_afsk>();
 }
 
-void UHF_Transceiver::setPAOffDelayAFSK(uint8_t delay) {
-	i2c.write(PTT_OFF_DELAY_AFSK, delay);
+template <class Bus>
+void UHF_Transceiver<Bus>::setPAOffDelayAFSK(uint8_t delay) {
+	I2C_PROFILE_SCOPE();
+	writeReg<reg_ptt_off_delay_afsk>(delay);
 }
 
-uint8_t UHF_Transceiver::getFirmware() {
-	uint8_t version = i2c.read(FIRMWARE_VERSION);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getFirmware() {
+	I2C_PROFILE_SCOPE();
+	uint8_t version = readReg<reg_firmware_version>();
 	uint8_t major = (version >> 4) & 0xF;
 	uint8_t minor = (version >> 0) & 0xF;
 
-	std::string out_str = "Software Version: " + std::to_string(major) + "." + std::to_string(minor);
-	printi(out_str);
+	UHF_INFO("Software Version: %d.%d", major, minor);
 
 	return version;
 }
 
-uint8_t UHF_Transceiver::getReadySignals() {
-	return i2c.read(READY_SIGNALS);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getReadySignals() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_ready_signals>();
 }
 
-bool UHF_Transceiver::transmitReady() {
+template <class Bus>
+bool UHF_Transceiver<Bus>::transmitReady() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
 	uint8_t status = getReadySignals();
 	bool ready = BIT_VAL(status, 0);
 
-	std::string out_str = "Tx Status: ";
-	if (ready) out_str += "Ready to transmit.";
-	else 	   out_str += "Not ready to transmit.";
+	const char* out_str = "";
+	if (ready) out_str = "Ready to transmit.";
+	else 	   out_str = "Not ready to transmit.";
 
-	printi(out_str);
+	UHF_INFO("Tx Status: %s", out_str);
 	return ready;
 }
 
-bool UHF_Transceiver::receiveReady() {
+template <class Bus>
+bool UHF_Transceiver<Bus>::receiveReady() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
 	uint8_t status = getReadySignals();
 	bool ready = BIT_VAL(status, 1);
 	
-	std::string out_str = "Rx Status: ";
-	if (ready) out_str += "Ready to receive.";
-	else 	   out_str += "Not ready to receive.";
+	const char* out_str = "";
+	if (ready) out_str = "Ready to receive.";
+	else 	   out_str = "Not ready to receive.";
 
-	printi(out_str);
+	UHF_INFO("Rx Status: %s", out_str);
 	return ready;
 }
 
-uint16_t UHF_Transceiver::getRxBufferCount() {
-	uint16_t cnt = i2c.read2(RX_BUFFER_CNT);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getRxBufferCount() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	uint16_t cnt = readReg<reg_rx_buffer_cnt>();
 
-	std::string out_str = "Rx Queue Status: ";
-	if (!cnt) out_str += "No bytes in the receive queue."; 							// pp. 24
-	else 	  out_str += std::to_string(cnt) + "bytes in the receive queue.";
-
-	printi(out_str);
+	if (!cnt) UHF_INFO("Rx Queue Status: No bytes in the receive queue."); 			// pp. 24
+	else 	  UHF_INFO("Rx Queue Status: %u bytes in the receive queue.", cnt);
 	return cnt;
 }
 
-uint8_t	UHF_Transceiver::readByte() {
-	while(!receiveReady());
-	uint8_t data = i2c.read(RX_DATA);
+template <class Bus>
+int UHF_Transceiver<Bus>::getRxStatus(uint16_t* rx_count, uint16_t* packet_cnt) {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	I2C_Batch status;
+	int cnt = batch_read<urtx_burst_t<reg_rx_buffer_cnt>>(&status);
+	int packets = batch_read<urtx_burst_t<reg_rx_packet_cntr>>(&status);
+	if (i2c.execute(&status) < 0) {
+		LOG_ERROR("Unable to read the receive status.");
+		*rx_count = 0;
+		return -1;
+	}
+
+	*rx_count = reg_rx_buffer_cnt::decode(status.getn(cnt));
+	*packet_cnt = reg_rx_packet_cntr::decode(status.getn(packets));
+	return 0;
+}
+
+template <class Bus>
+uint8_t	UHF_Transceiver<Bus>::readByte() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	if (waitReceiveReady() < 0) return 0x00;
+	uint8_t data = readReg<reg_rx_data>();
 
 	if (data == 0xFF) {
 		data = 0x00;		// returns null character
-		printi("No data available in the receive buffer."); // pp. 24
+		UHF_INFO("No data available in the receive buffer."); // pp. 24
 	}
 
 	return data;
 }
 
-uint8_t* UHF_Transceiver::readNBytes(int n, uint8_t* data) {
+template <class Bus>
+uint8_t* UHF_Transceiver<Bus>::readNBytes(int n, uint8_t* data) {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
 	/* requires {uint8_t data[n];} prior to call. the values are returned in the 'data' variable. */
-	while(!receiveReady());	// loop until ready to receive
-	i2c.readn(RX_DATA, n, data);
+	/* RX_DATA is a FIFO, so longer transfers are split into bounded transactions */
+	for (int i = 0; i < n; i += I2C_MAX_TRANSFER_LEN) {
+		int len = (n - i < I2C_MAX_TRANSFER_LEN) ? n - i : I2C_MAX_TRANSFER_LEN;
+		if (waitReceiveReady() < 0) break;	// loop until ready to receive
+		/* bytes popped by a failed read are gone, so it is not replayed: the caller drops the packet */
+		if (!i2c.readn(RX_DATA, len, &data[i], false)) {
+			LOG_ERROR("Unable to read %d bytes from RX_DATA.", len);
+			return 0;
+		}
+	}
 	return data;
 }
 
-std::string UHF_Transceiver::readString(int n, uint8_t* data) {
+template <class Bus>
+std::string UHF_Transceiver<Bus>::readString(int n, uint8_t* data) {
+	I2C_PROFILE_SCOPE();
 	/* requires {uint8_t data[n];} prior to call. the values are returned in the 'data' variable. */
 	uint8_t* incoming_raw = readNBytes(n, data);
+	if (!incoming_raw) return "";
 	std::string str = (char*)incoming_raw;
 	return str;
 }
 
 /* NOT MEANT FOR USE */
-std::string UHF_Transceiver::readUntilDelimiter(char delimiter) {
+template <class Bus>
+std::string UHF_Transceiver<Bus>::readUntilDelimiter(char delimiter) {
+	I2C_PROFILE_SCOPE();
 	std::string data;
 	char incoming = (char)readByte();
 	while (incoming != delimiter) {
@@ -473,155 +978,291 @@ std::string UHF_Transceiver::readUntilDelimiter(char delimiter) {
 	return data;
 }
 
-uint16_t UHF_Transceiver:: getTxFreeSlots() {
-	return i2c.read2(TX_BUFFER_FREE_SLOTS);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>:: getTxFreeSlots() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_DATA);
+	return readReg<reg_tx_buffer_free_slots>();
 }
 
-uint16_t UHF_Transceiver::getRxCRCFailCnt() {
-	return i2c.read2(RX_CRC_FAIL_CNTR);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getRxCRCFailCnt() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readReg<reg_rx_crc_fail_cntr>();
 }
 
-uint16_t UHF_Transceiver::getRxPacketCnt() {
-	return i2c.read2(RX_PACKET_CNTR);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getRxPacketCnt() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readReg<reg_rx_packet_cntr>();
 }
 
-uint8_t UHF_Transceiver::getDroppedPackets() {
-	return i2c.read(RX_FULL_FAIL_CNTR);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getDroppedPackets() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readReg<reg_rx_full_fail_cntr>();
 }
 
-uint16_t UHF_Transceiver::getTxBufferOverrunCnt() {
-	return i2c.read2(TX_BUFFER_OVERRUN);
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getTxBufferOverrunCnt() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readReg<reg_tx_buffer_overrun>();
 }
 
-uint8_t UHF_Transceiver::getFreqLockInfo() {
-	return i2c.read(FREQUENCY_LOCK);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getFreqLockInfo() {
+	I2C_PROFILE_SCOPE();
+	return readReg<reg_frequency_lock>();
 }
 
-bool UHF_Transceiver::getRxLock() {
-	uint8_t status = getReadySignals();
+template <class Bus>
+bool UHF_Transceiver<Bus>::getRxLock() {
+	I2C_PROFILE_SCOPE();
+	uint8_t status = getFreqLockInfo();
 	bool is_locked = BIT_VAL(status, 0);
 
-	std::string    out_str  = "Rx Frequency Lock Status: ";
-	if (is_locked) out_str += "Locked.";
-	else           out_str += "Not locked.";
+	const char*    out_str  = "";
+	if (is_locked) out_str = "Locked.";
+	else           out_str = "Not locked.";
 
-	printi(out_str);
+	UHF_INFO("Rx Frequency Lock Status: %s", out_str);
 	return is_locked;
 }
 
-bool UHF_Transceiver::getTxLock() {
-	uint8_t status = getReadySignals();
+template <class Bus>
+bool UHF_Transceiver<Bus>::getTxLock() {
+	I2C_PROFILE_SCOPE();
+	uint8_t status = getFreqLockInfo();
 	bool is_locked = BIT_VAL(status, 1);
 
-	std::string out_str = "Tx Frequency Lock Status: ";
-	if (is_locked) out_str += "Locked.";
-	else           out_str += "Not locked.";
+	const char* out_str = "";
+	if (is_locked) out_str = "Locked.";
+	else           out_str = "Not locked.";
 
-	printi(out_str);
+	UHF_INFO("Tx Frequency Lock Status: %s", out_str);
 	return is_locked;
 }
 
-bool UHF_Transceiver::testLocks() {
-	return getTxLock() && getRxLock();
+template <class Bus>
+bool UHF_Transceiver<Bus>::testLocks() {
+	I2C_PROFILE_SCOPE();
+	uint8_t status = getFreqLockInfo();						// both lock signals share one register
+	return BIT_VAL(status, 0) && BIT_VAL(status, 1);
 }
 
-uint8_t UHF_Transceiver::getDTMFInfo() {
-	return i2c.read(DTMF);
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getDTMFInfo() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readReg<reg_dtmf>();
 }
 
-uint8_t UHF_Transceiver::getLastDTMFTone() {
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getLastDTMFTone() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
 	uint8_t info = getDTMFInfo();
 	info &= 0xF;
 	return info;
 }
 
-uint8_t UHF_Transceiver::getDTMFToneCnt() {
+template <class Bus>
+uint8_t UHF_Transceiver<Bus>::getDTMFToneCnt() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
 	uint8_t info = getDTMFInfo();
 	info = (info >> 4) & 0xF;
 	return info;
 }
 
-float UHF_Transceiver::getRSSI() {
-	uint16_t val = i2c.read2(RSSI);
-	float rssi = val * 0.00073242187;								// val * (3/4096) [V]	(see pp. 26)
-	return rssi;
+template <class Bus>
+float UHF_Transceiver<Bus>::getRSSI() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readConv<reg_rssi>();
 }
 
-int UHF_Transceiver::getSMPSTemp() {
-	uint8_t temp = i2c.read(SMPS_TEMP);
+template <class Bus>
+int UHF_Transceiver<Bus>::getSMPSTemp() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	uint8_t temp = readReg<reg_smps_temp>();
 	return (int)temp;
 }
 
-int UHF_Transceiver::getPATemp() {
-	uint8_t temp = i2c.read(PA_TEMP);
+template <class Bus>
+int UHF_Transceiver<Bus>::getPATemp() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	uint8_t temp = readReg<reg_pa_temp>();
 	return (int)temp;
 }
 
-float UHF_Transceiver::getCurrent3V3() {
-	uint16_t val = i2c.read2(CURRENT_3V3);
-	float current = val * 0.000003;									// val * (3e-6) [A]   (see pp. 27)
-	return current;
+template <class Bus>
+float UHF_Transceiver<Bus>::getCurrent3V3() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readConv<reg_current_3v3>();
 }
 
-float UHF_Transceiver::getVoltage3V3() {
-	uint16_t val = i2c.read2(VOLTAGE_3V3);
-	val &= 0x1FFF;
-	float voltage = val * 0.004;									// val * (4e-3) [V]   (see pp. 27)
-	return voltage;
+template <class Bus>
+float UHF_Transceiver<Bus>::getVoltage3V3() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readConv<reg_voltage_3v3>();
 }
 
-float UHF_Transceiver::getCurrent5V() {
-	uint16_t val = i2c.read2(CURRENT_5V);
-	float current = val * 0.000062;									// val * (62e-6) [A]   (see pp. 27)
-	return current;
+template <class Bus>
+float UHF_Transceiver<Bus>::getCurrent5V() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readConv<reg_current_5v>();
 }
 
-float UHF_Transceiver::getVoltage5V() {
-	uint16_t val = i2c.read2(VOLTAGE_5V);
-	val &= 0x1FFF;
-	float voltage = val * 0.004;									// val * (4e-3) [V]   (see pp. 27)
-	return voltage;
+template <class Bus>
+float UHF_Transceiver<Bus>::getVoltage5V() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	return readConv<reg_voltage_5v>();
 }
 
-uint16_t UHF_Transceiver::getPAForwardPower() {
-	uint16_t val = i2c.read2(PA_POWER_FORWARD) & 0xFFF;
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getPAForwardPower() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	uint16_t val = readReg<reg_pa_power_forward>();
 	return val;
 }
 
-float UHF_Transceiver::getCoupledPAForwardPower() {
-	uint16_t val = getPAForwardPower();
-	float x = val * 0.00073242187;									// val * (3/4096) [V] (see pp. 28)
-	float y = -68838*pow(x,6) + 228000*pow(x,5) - 308831*pow(x,4) + 218934*pow(x,3) - 85741*pow(x,2) + 17660*val - 1511.8;	// in dB, pp. 28
-	return y;
+template <class Bus>
+float UHF_Transceiver<Bus>::getCoupledPAForwardPower() {
+	I2C_PROFILE_SCOPE();
+	return conv(reg_pa_power_forward::channel, getPAForwardPower());
 }
 
-float UHF_Transceiver::getActualPAForwardPower() {
-	return getCoupledPAForwardPower() + 32.5;						// in dB  (see pp. 28)
+template <class Bus>
+float UHF_Transceiver<Bus>::getActualPAForwardPower() {
+	I2C_PROFILE_SCOPE();
+	return getCoupledPAForwardPower() + PA_COUPLING_DB;
 }
 
-uint16_t UHF_Transceiver::getPAReversePower() {
-	uint16_t val = i2c.read2(PA_POWER_REVERSE) & 0xFFF;
+template <class Bus>
+uint16_t UHF_Transceiver<Bus>::getPAReversePower() {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	uint16_t val = readReg<reg_pa_power_reverse>();
 	return val;
 }
 
-float UHF_Transceiver::getCoupledPAReversePower() {
-	uint16_t val = getPAReversePower();
-	float x = val * 0.00073242187;									// val * (3/4096) [V] (see pp. 28)
-	float y = -68838*pow(x,6) + 228000*pow(x,5) - 308831*pow(x,4) + 218934*pow(x,3) - 85741*pow(x,2) + 17660*val - 1511.8;	// in dB, pp. 28
-	return y;
+template <class Bus>
+float UHF_Transceiver<Bus>::getCoupledPAReversePower() {
+	I2C_PROFILE_SCOPE();
+	return conv(reg_pa_power_reverse::channel, getPAReversePower());
 }
 
-float UHF_Transceiver::getActualPAReversePower() {
-	return getCoupledPAReversePower() + 32.5;						// in dB  (see pp. 28)
+template <class Bus>
+float UHF_Transceiver<Bus>::getActualPAReversePower() {
+	I2C_PROFILE_SCOPE();
+	return getCoupledPAReversePower() + PA_COUPLING_DB;
 }
 
-float UHF_Transceiver::getPAReverseLoss() {
+template <class Bus>
+float UHF_Transceiver<Bus>::getPAReverseLoss() {
+	I2C_PROFILE_SCOPE();
 	return getActualPAReversePower() - getActualPAForwardPower();	// in dB  (see pp. 28)
 }
 
+template <class Bus>
+int UHF_Transceiver<Bus>::getTelemetry(TelemetrySnapshot* snapshot) {
+	I2C_PROFILE_SCOPE();
+	I2C_PRIORITY(I2C_PRIORITY_TELEMETRY);
+	uint8_t block[urtx_telemetry_t::len];
+
+	/* the sensor registers are contiguous, so one burst gives readings from the same instant */
+	if (!i2c.readn(urtx_telemetry_t::addr, urtx_telemetry_t::len, block)) {
+		LOG_ERROR("Unable to read the telemetry block.");
+		return -1;
+	}
+	snapshot->timestamp = std::chrono::steady_clock::now();
+
+	#define TELEMETRY(reg)		urtx_telemetry_t::decode<reg>(block)
+	snapshot->rssi = conv(reg_rssi::channel, TELEMETRY(reg_rssi));
+	snapshot->smps_temp = TELEMETRY(reg_smps_temp);
+	snapshot->pa_temp = TELEMETRY(reg_pa_temp);
+	snapshot->current_3v3 = conv(reg_current_3v3::channel, TELEMETRY(reg_current_3v3));
+	snapshot->voltage_3v3 = conv(reg_voltage_3v3::channel, TELEMETRY(reg_voltage_3v3));
+	snapshot->current_5v = conv(reg_current_5v::channel, TELEMETRY(reg_current_5v));
+	snapshot->voltage_5v = conv(reg_voltage_5v::channel, TELEMETRY(reg_voltage_5v));
+	snapshot->pa_forward_raw = TELEMETRY(reg_pa_power_forward);
+	snapshot->pa_reverse_raw = TELEMETRY(reg_pa_power_reverse);
+	#undef TELEMETRY
+
+	snapshot->pa_forward_power = conv(reg_pa_power_forward::channel, snapshot->pa_forward_raw) + PA_COUPLING_DB;
+	snapshot->pa_reverse_power = conv(reg_pa_power_reverse::channel, snapshot->pa_reverse_raw) + PA_COUPLING_DB;
+	snapshot->pa_reverse_loss = snapshot->pa_reverse_power - snapshot->pa_forward_power;
+	return 0;
+}
+
+/*************************** Async ***************************/
+
+template <class Bus>
+std::future<int> UHF_Transceiver<Bus>::sendNBytesAsync(const uint8_t* data, int n) {
+	std::vector<uint8_t> frame(data, data + n);				// the caller may reuse its buffer immediately
+	return worker.submit<int>([this, frame]() { return sendNBytes(frame.data(), frame.size()); });
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::sendNBytesAsync(const uint8_t* data, int n, std::function<void(int)> done) {
+	std::vector<uint8_t> frame(data, data + n);
+	worker.post([this, frame, done]() { done(sendNBytes(frame.data(), frame.size())); });
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::sendNBytesAsync(tx_span_t* span) {
+	/* capturing two pointers keeps the task inside std::function's own storage */
+	span->begin();
+	worker.post([this, span]() { span->complete(sendNBytes(span->data, span->n)); });
+}
+
+template <class Bus>
+std::future<uint8_t*> UHF_Transceiver<Bus>::readNBytesAsync(int n, uint8_t* data) {
+	return worker.submit<uint8_t*>([this, n, data]() { return readNBytes(n, data); });
+}
+
+template <class Bus>
+std::future<uint16_t> UHF_Transceiver<Bus>::getRxBufferCountAsync() {
+	return worker.submit<uint16_t>([this]() { return getRxBufferCount(); });
+}
+
+template <class Bus>
+int UHF_Transceiver<Bus>::runOnWorker(std::function<int()> setup) {
+	return worker.submit<int>(setup).get();
+}
+
+template <class Bus>
+const i2c_stats_t& UHF_Transceiver<Bus>::getBusStats() {
+	return i2c.get_stats();
+}
+
+template <class Bus>
+void UHF_Transceiver<Bus>::printBusStats() {
+	i2c.print_stats();
+
+	const tx_stats_t& tx = getTxStats();
+	std::cout << std::dec;
+	std::cout << "Streaming TX (" << tx_capacity << " byte FIFO, threshold " << tx_low_water << "):" << std::endl;
+	std::cout << "\tBytes: " << tx.bytes << ", Bursts: " << tx.bursts << ", Slot Reads: " << tx.slot_reads << ", Waits: " << tx.waits << std::endl;
+	std::cout << "\tUnderruns: " << tx.underruns << ", Overruns: " << tx.overruns << std::endl;
+}
+
 /************************** Testing **************************/
 
- void UHF_Transceiver::sendStringTest(const std::string &data, uint8_t n) {
+ template <class Bus>
+ void UHF_Transceiver<Bus>::sendStringTest(const std::string &data, uint8_t n) {
 	 char* data_arr = new char[n+1];
 	 for (int i = 0; i < n; i++) {
 	 	data_arr[i] = data.at(i);
@@ -631,4 +1272,7 @@ float UHF_Transceiver::getPAReverseLoss() {
 	 for (int i = 0; i < n; i++) {
 		 i2c.print_uint8("", data_out[i]);
 	 }
- }
\ No newline at end of file
+ }
+
+/* instantiated for the bus policy of this build (see I2C_Policy.h) */
+template class UHF_Transceiver<I2C_Bus>;
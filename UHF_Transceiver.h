@@ -20,77 +20,110 @@
 #include <string>
 #include <string.h>
 #include <math.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
 #include "I2C_Functions.h"
+#include "URTX_Registers.h"
+#include "I2C_Worker.h"
+#include "Log.h"
 
 
 /*************************** Defines ***************************/
-#define TRANSCEIVER_I2C_ADDR    0x25
 #define DATAFIELD_LEN           256
+#define RX_FIFO_LEN             2048                        // bytes the receive buffer holds (RX_BUFFER_CNT never reports more)
+#define READY_TIMEOUT_MS        1000                        // longest wait for the transmit/receive ready signals
+#define CONFIG_BLOCK_LEN        (PTT_OFF_DELAY_GMSK + 1)		// registers 0x00 - 0x14
+#define TX_GMSK_BPS             9600                        // downlink line rate with MODEM_GMSK_DOWN set
+#define TX_AFSK_BPS             1200                        // downlink line rate otherwise
+#define TX_LOW_WATER_MS         50                          // airtime left in the TX FIFO when it is reported almost empty
+#define TX_MIN_BURST            32                          // smallest top-up worth a transaction (unless the frame ends sooner)
+#define LOCK_POLL_MIN_US        500                         // first wait between frequency lock polls
+#define LOCK_POLL_MAX_US        20000                       // longest wait between frequency lock polls
 
-// Registers (pp. 19 of 31)                DESCRIPTION
-#define MODEM_CONFIG			0x00	// select uplink and downlink modulation scheme
-#define AX25_TX_DELAY			0x01	// AX.25 transmission delay
-#define SYNC_BYTES				0x02	// configure the sync byte value
-#define TX_DATA 				0x03	// data to be transmitted
-#define BEACON_CTRL				0x04 	// beacon control
-#define BEACON_DATA				0x05	// write data for the custom beacon portion
-#define PA_POWER_LVL			0x06	// power amplifier level
-#define RX_OFFSET				0x07	// select an alternative receive frequency
-#define TX_OFFSET				0x09	// select an alternative transmit frequency
-#define INITIAL_I2C_TIMEOUT		0x0B	// beacon’s initial I2C timeout (1–7 min)
-#define RECURRING_I2C_TIMEOUT	0x0C	// beacon’s recurring I2C timeout (10–127 sec)
-#define DEBUG_REG				0x0D	// LED control for debugging
-#define RESET 					0x0E	// resets all registers
-#define TRANSPARENT_MODE		0x10 	// select between AX.25 and convolutional encoder
-#define ALMOST_EMPTY_THRESHOLD 	0x11	// define transmit ready threshold
-#define PTT_OFF_DELAY_AFSK		0x13	// time following a transmit sequence before PA is turned off (default = 10ms)
-#define PTT_OFF_DELAY_GMSK		0x14	// time following a transmit sequence before PA is turned off (default = 1ms)
-#define FIRMWARE_VERSION		0x19	// firmware version number (bits 7:4 - major, 3:0 - minor)
-#define READY_SIGNALS			0x1A	// transmit ready (TR) and receive ready (RR) signals
-#define RX_BUFFER_CNT			0x1B	// number of bytes to be read from the receive buffer
-#define RX_DATA					0x1D	// data receivied
-#define TX_BUFFER_FREE_SLOTS	0x1E	// number of free slots in the transmit buffer
-#define RX_CRC_FAIL_CNTR		0x21    // number of AX.25 packets dropped as a result of AX.25 frame check sequence
-#define RX_PACKET_CNTR			0x23	// number of successfully received packets	
-#define RX_FULL_FAIL_CNTR		0x25 	// packets dropped as a result of insufficient space in receive buffer
-#define TX_BUFFER_OVERRUN   	0x26	// counts times when byte is written to transmit buffer when no free slots available
-#define FREQUENCY_LOCK			0x28	// frequency lock detect signals for both transmitter (TXL) and receiver (RXL)
-#define DTMF					0x29 	// DTMF tone (3:0) and tone received  counter (7:4)
-#define RSSI					0x2A 	// received signal strength indicator (RSSI)
-#define SMPS_TEMP				0x2C 	// switched-mode power supply temperature reading of most recent conversion
-#define PA_TEMP 				0x2D 	// power amplifier temperature reading of most recent conversion
-#define CURRENT_3V3 			0x2E 	// most recent reading from the 3.3 V current sensor
-#define VOLTAGE_3V3             0x30  	// most recent reading of bus voltage on 5 V supply
-#define CURRENT_5V  			0x32 	// most recent reading from the 5 V current sensor
-#define VOLTAGE_5V           	0x34  	// most recent reading of bus voltage on 3.3 V supply
-#define PA_POWER_FORWARD 		0x36  	// value used to compute actual forward power
-#define PA_POWER_REVERSE 		0x38 	// value used to compute actual reverse power
-
-/* 13.4.1 Register 0x00: Modem configuration register */
-#define MODEM_GMSK_DOWN			0b01
-#define MODEM_GMSK_UP			0b10
-#define MODEM_GMSK_BOTH			0b11
-
-/* 13.4.6 Register 0x05: Beacon data register */
-#define BEACON_DATA_BUFFER_LEN  128
-
-/* 13.4.7 Register 0x06: PA power level register */
-#define PA_LVL_27				0b00
-#define PA_LVL_30				0b01
-#define PA_LVL_33				0b10
-#define PA_LVL_INHIBIT			0b11
-
-/* 13.4.14 Register 0x10: Transparent mode register */
-#define AX25_MODE				0x06
-#define TRANS_MODE_CONV_ENABLE	0x0D
-#define TRANS_MODE_CONV_DISABLE 0x05
+
+/* every sensor reading of the transceiver, taken in one burst (see pp. 26-28) */
+struct TelemetrySnapshot {
+	std::chrono::steady_clock::time_point timestamp;	// when the burst was read
+	float rssi;											// V
+	int smps_temp;										// C
+	int pa_temp;										// C
+	float current_3v3;									// A
+	float voltage_3v3;									// V
+	float current_5v;									// A
+	float voltage_5v;									// V
+	uint16_t pa_forward_raw;							// unconverted PA forward power reading
+	uint16_t pa_reverse_raw;							// unconverted PA reverse power reading
+	float pa_forward_power;								// actual forward power in dB
+	float pa_reverse_power;								// actual reverse power in dB
+	float pa_reverse_loss;								// dB
+};
+
+
+/* the configuration written at startup in one transaction (see applyProfile) */
+struct urtx_profile_t {
+	uint8_t modem_config;								// MODEM_GMSK_*
+	uint8_t pa_power;									// PA_LVL_*
+	float rx_freq;										// MHz (430 - 440)
+	float tx_freq;										// MHz (430 - 440)
+	uint8_t initial_timeout;							// beacon's initial I2C timeout (1 - 7 min)
+	uint8_t recurring_timeout;							// beacon's recurring I2C timeout (10 - 127 s)
+	uint8_t mode;										// AX25_MODE or TRANS_MODE_*
+};
+
+/* streaming transmit counters (see sendNBytes) */
+struct tx_stats_t {
+	uint64_t bytes;										// bytes written into TX_DATA
+	uint64_t bursts;									// TX_DATA transactions
+	uint64_t slot_reads;								// TX_BUFFER_FREE_SLOTS reads
+	uint64_t waits;										// times the FIFO was too full for a burst
+	uint64_t underruns;									// times the FIFO was found empty in the middle of a stream
+	uint64_t overruns;									// TX_BUFFER_OVERRUN increments since configureTxStream()
+};
+
+
+/* a frame lent to the bus worker without copying (see sendNBytesAsync): the caller leaves the bytes alone until wait() returns */
+struct tx_span_t {
+	const uint8_t* data;
+	int n;
+
+	void begin() {
+		std::lock_guard<std::mutex> guard(lock);
+		busy = true;
+	}
+
+	void complete(int result) {
+		std::lock_guard<std::mutex> guard(lock);
+		status = result;
+		busy = false;
+		done.notify_one();
+	}
+
+	int wait() {											// status of the transmission (0 if nothing was lent)
+		std::unique_lock<std::mutex> guard(lock);
+		done.wait(guard, [this]() { return !busy; });
+		return status;
+	}
+
+private:
+	std::mutex lock;
+	std::condition_variable done;
+	bool busy = false;
+	int status = 0;
+};
 
 
 /********************* UHF Transceiver  **********************/
+/* Bus is the transport policy (see I2C_Policy.h); register access resolves to it at compile time. */
+template <class Bus>
 class UHF_Transceiver {
 
 private:
-	I2C_Functions i2c;
+	I2C_Functions<Bus> i2c;
+	I2C_Worker worker;										// executes the asynchronous requests (declared after i2c, so stopped first)
 
 	void beaconEnable(bool enable);							// enables or disables the beacon functionality
 	uint16_t getRxFreqOffset();								// gets data in the receiving frequency offset register
@@ -102,14 +135,44 @@ private:
 	uint8_t getDTMFInfo();									// gets relevant Dual-Tone Multi-Frequency (DTMF) information
 	uint16_t getPAForwardPower();							// gets raw, unconverted PA forward power reading
 	uint16_t getPAReversePower();							// gets raw, unconverted PA reverse power reading	
+	int waitTransmitReady();								// polls the transmit ready signal for up to READY_TIMEOUT_MS
+	int waitReceiveReady();									// polls the receive ready signal for up to READY_TIMEOUT_MS
+	int readConfigBlock(uint8_t* actual);					// reads every configuration register (FIFOs and reset excluded) in one transaction
+
+	/* Shadow Registers */
+	uint8_t shadow[CONFIG_BLOCK_LEN];						// last value written to (or read from) each configuration register
+	uint32_t shadow_valid;									// bit n is set once shadow[n] is known
+	uint32_t shadow_written;								// bit n is set once shadow[n] was written (what repairConfig() restores)
+	uint8_t readShadow(uint8_t reg);						// reads a configuration register from the shadow copy
+	uint16_t readShadow2(uint8_t reg);						// reads a 2-byte configuration register from the shadow copy
+	void writeShadow(uint8_t reg, uint8_t data);			// writes a configuration register through the shadow copy
+	void writeShadow2(uint8_t reg, uint16_t data);			// writes a 2-byte configuration register through the shadow copy
+
+	/* Register Access (descriptors in URTX_Registers.h; width, mask and access are checked at compile time) */
+	template <class Reg> uint16_t readReg();				// reads a register (from the shadow copy, if it has one), masked
+	template <class Reg> void writeReg(uint16_t data);		// writes a register (through the shadow copy, if it has one)
+	template <class Reg> float readConv();					// reads a sensor register and converts it to engineering units
+
+	/* Streaming Transmit */
+	uint16_t tx_free;										// free slots known to be in the TX FIFO (a lower bound: the modem only drains it)
+	uint16_t tx_capacity;									// largest free slot count seen, i.e. the FIFO size
+	uint16_t tx_low_water;									// ALMOST_EMPTY_THRESHOLD, in bytes
+	uint32_t tx_line_bps;									// downlink bit rate, kept here so the bus worker never reads the register shadow
+	uint16_t tx_overrun_base;								// TX_BUFFER_OVERRUN when the counters were cleared
+	bool tx_streaming;										// a stream is open (see endTxStream)
+	tx_stats_t tx_stats;
+	void refreshTxFreeSlots();								// reads the free slot count, noting underruns
+
+	/* Beacon Cache */
+	uint8_t beacon[BEACON_DATA_BUFFER_LEN];					// payload last loaded into the beacon buffer
+	int beacon_len;
+	bool beacon_valid;										// false once the buffer contents are unknown
 
 	/* Debug Functions */
-    bool debug;
-    void printe(std::string str) { if (debug) std::cout << "ERROR: " << str << " (UHF_Transceiver.cpp)" << std::endl; }
-	void printi(std::string str) { if (debug) std::cout << "INFO: " << str << " (UHF_Transceiver.cpp)" << std::endl; }	
+    bool debug;												// also gates the INFO records (see Log.h for the compile-time level)
 
 public: 
-    explicit UHF_Transceiver(bool debug = true, uint8_t bus = 2);
+    explicit UHF_Transceiver(bool debug = false, uint8_t bus = 2);
 	uint8_t getModemConfig();								// reports modulation scheme
 	void setModemConfig(uint8_t config);					// sets modulation scheme
 	void setTransmissionDelay(uint8_t delay);				// sets AX.25 transmission delay (1-255)
@@ -117,14 +180,17 @@ public:
 	void setSyncBytes(uint8_t val);							// configure the sync byte value
 	uint8_t getSyncBytes();									// read the sync byte value
 	void sendByte(uint8_t data);							// transmits a byte of data
-	void sendNBytes(uint8_t* data, int n);					// transmits 'n' bytes of data
-	void sendString(const std::string &data, uint8_t n);	// transmits a string of data
+	int sendNBytes(const uint8_t* data, int n);				// transmits 'n' bytes of data, topping up the TX FIFO in free-slot-sized bursts
+	int configureTxStream();								// sizes the TX FIFO and sets the almost-empty threshold from the line rate
+	void endTxStream();										// the FIFO may now run dry without counting as an underrun
+	const tx_stats_t& getTxStats();							// fetches the streaming counters (refreshes the overrun count)
+	void sendString(const std::string &data, int n);		// transmits the first 'n' bytes of a string
 	uint8_t getBeaconCtrl();								// reads the beacon control register
 	void clearBeaconData();									// clears the beacon data
 	void enableBeacon();									// enables the beacon functionality
 	void disableBeacon();									// disables the beacon functionality
 	void setBeaconData(uint8_t data);						// sets one byte of the beacon data
-	void setBeaconOutput(std::string str);					// sets the beacon data to a string
+	void setBeaconOutput(const std::string& str);			// loads the beacon buffer in one transaction (skipped if unchanged)
 	uint8_t getPAPower();									// gets the Power Amplifier power level
 	void setPAPower(uint8_t config);						// sets the Power Amplifier power level
 	void setRxFreq(float freq);								// set receiving requency
@@ -148,8 +214,9 @@ public:
 	bool transmitReady();									// determines whether data can be transmitted
 	bool receiveReady();									// determines whether data can be received
 	uint16_t getRxBufferCount();							// determines number of bytes to be read from the receive buffer
+	int getRxStatus(uint16_t* rx_count, uint16_t* packet_cnt);	// reads the receive buffer count and packet counter in one transaction
 	uint8_t readByte();										// fetches the data from the received data buffer
-	uint8_t* readNBytes(int n, uint8_t* data);				// fetches 'n' bytes from the received data buffer
+	uint8_t* readNBytes(int n, uint8_t* data);				// fetches 'n' bytes from the received data buffer (0 if a read failed)
 	std::string readString(int n, uint8_t* data);			// fetches 'n' bytes from the received data buffer, returns string
 	std::string readUntilDelimiter(char delimiter);			// NOT MEANT FOR USE: reads data until a selected delimiter (e.g. EOF) is read
 	uint16_t getTxFreeSlots();								// determines number of free slots in the transmit buffer
@@ -174,6 +241,20 @@ public:
 	float getCoupledPAReversePower();						// coupled reverse power reading in dB
 	float getActualPAReversePower();						// actual reverse reading in dB
 	float getPAReverseLoss();								// power amplifier reverse loss in dB
+	int getTelemetry(TelemetrySnapshot* snapshot);			// reads and decodes every sensor register in one transaction
+	int repairConfig();										// reads back the configuration block, rewrites drifted registers (returns how many)
+	int applyProfile(const urtx_profile_t& profile);		// writes the startup configuration in one transaction and verifies it with one readback
+	int waitForLock(uint32_t timeout_ms);					// polls both frequency locks with a growing backoff, returns the wait in ms (-1 on timeout)
+	const i2c_stats_t& getBusStats();						// I2C bus statistics of the session
+	void printBusStats();									// prints the I2C bus and streaming transmit statistics
+
+	/**** Async Functions (executed in order on the bus worker thread) ****/
+	std::future<int> sendNBytesAsync(const uint8_t* data, int n);							// copies and transmits 'n' bytes
+	void sendNBytesAsync(const uint8_t* data, int n, std::function<void(int)> done);		// same, completion reported to 'done'
+	void sendNBytesAsync(tx_span_t* span);													// transmits the span in place, no copy and no allocation
+	std::future<uint8_t*> readNBytesAsync(int n, uint8_t* data);							// fetches 'n' bytes ('data' must outlive the future)
+	std::future<uint16_t> getRxBufferCountAsync();											// determines number of bytes in the receive buffer
+	int runOnWorker(std::function<int()> setup);											// runs 'setup' on the bus worker thread and waits for its result
 
 	/**** Debug Functions ****/ 
 	uint8_t getDebug();
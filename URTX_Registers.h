@@ -0,0 +1,198 @@
+/****************************************************************************
+* URTX_Registers.h
+*
+* @hardware    : UHF Transceiver
+* @manual      : USM-01-00097 User Manual Rev. C
+* @about       : The register map of the UHF transceiver.
+* @author      : Carlos Carrasquillo
+* @contact     : c.carrasquillo@ufl.edu
+* @date        : August 20, 2020
+* @modified    : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef URTX_REGISTERS
+#define URTX_REGISTERS
+
+#include <stdint.h>
+#include <type_traits>
+#include "Conversions.h"
+
+#define TRANSCEIVER_I2C_ADDR    0x25
+
+// Registers (pp. 19 of 31)                DESCRIPTION
+#define MODEM_CONFIG			0x00	// select uplink and downlink modulation scheme
+#define AX25_TX_DELAY			0x01	// AX.25 transmission delay
+#define SYNC_BYTES				0x02	// configure the sync byte value
+#define TX_DATA 				0x03	// data to be transmitted
+#define BEACON_CTRL				0x04 	// beacon control
+#define BEACON_DATA				0x05	// write data for the custom beacon portion
+#define PA_POWER_LVL			0x06	// power amplifier level
+#define RX_OFFSET				0x07	// select an alternative receive frequency
+#define TX_OFFSET				0x09	// select an alternative transmit frequency
+#define INITIAL_I2C_TIMEOUT		0x0B	// beacon’s initial I2C timeout (1–7 min)
+#define RECURRING_I2C_TIMEOUT	0x0C	// beacon’s recurring I2C timeout (10–127 sec)
+#define DEBUG_REG				0x0D	// LED control for debugging
+#define RESET 					0x0E	// resets all registers
+#define TRANSPARENT_MODE		0x10 	// select between AX.25 and convolutional encoder
+#define ALMOST_EMPTY_THRESHOLD 	0x11	// define transmit ready threshold
+#define PTT_OFF_DELAY_AFSK		0x13	// time following a transmit sequence before PA is turned off (default = 10ms)
+#define PTT_OFF_DELAY_GMSK		0x14	// time following a transmit sequence before PA is turned off (default = 1ms)
+#define FIRMWARE_VERSION		0x19	// firmware version number (bits 7:4 - major, 3:0 - minor)
+#define READY_SIGNALS			0x1A	// transmit ready (TR) and receive ready (RR) signals
+#define RX_BUFFER_CNT			0x1B	// number of bytes to be read from the receive buffer
+#define RX_DATA					0x1D	// data receivied
+#define TX_BUFFER_FREE_SLOTS	0x1E	// number of free slots in the transmit buffer
+#define RX_CRC_FAIL_CNTR		0x21    // number of AX.25 packets dropped as a result of AX.25 frame check sequence
+#define RX_PACKET_CNTR			0x23	// number of successfully received packets	
+#define RX_FULL_FAIL_CNTR		0x25 	// packets dropped as a result of insufficient space in receive buffer
+#define TX_BUFFER_OVERRUN   	0x26	// counts times when byte is written to transmit buffer when no free slots available
+#define FREQUENCY_LOCK			0x28	// frequency lock detect signals for both transmitter (TXL) and receiver (RXL)
+#define DTMF					0x29 	// DTMF tone (3:0) and tone received  counter (7:4)
+#define RSSI					0x2A 	// received signal strength indicator (RSSI)
+#define SMPS_TEMP				0x2C 	// switched-mode power supply temperature reading of most recent conversion
+#define PA_TEMP 				0x2D 	// power amplifier temperature reading of most recent conversion
+#define CURRENT_3V3 			0x2E 	// most recent reading from the 3.3 V current sensor
+#define VOLTAGE_3V3             0x30  	// most recent reading of bus voltage on 5 V supply
+#define CURRENT_5V  			0x32 	// most recent reading from the 5 V current sensor
+#define VOLTAGE_5V           	0x34  	// most recent reading of bus voltage on 3.3 V supply
+#define PA_POWER_FORWARD 		0x36  	// value used to compute actual forward power
+#define PA_POWER_REVERSE 		0x38 	// value used to compute actual reverse power
+#define URTX_REG_END			0x3A	// one past the last register
+
+/* 13.4.1 Register 0x00: Modem configuration register */
+#define MODEM_GMSK_DOWN			0b01
+#define MODEM_GMSK_UP			0b10
+#define MODEM_GMSK_BOTH			0b11
+
+/* 13.4.6 Register 0x05: Beacon data register */
+#define BEACON_DATA_BUFFER_LEN  128
+
+/* 13.4.7 Register 0x06: PA power level register */
+#define PA_LVL_27				0b00
+#define PA_LVL_30				0b01
+#define PA_LVL_33				0b10
+#define PA_LVL_INHIBIT			0b11
+
+/* 13.4.14 Register 0x10: Transparent mode register */
+#define AX25_MODE				0x06
+#define TRANS_MODE_CONV_ENABLE	0x0D
+#define TRANS_MODE_CONV_DISABLE 0x05
+
+
+/************************* Descriptors *************************/
+
+enum reg_access_t {
+	REG_R	= 0b01,
+	REG_W	= 0b10,
+	REG_RW	= 0b11,
+};
+
+/* a register as a type: everything needed to access it is known at compile time (see UHF_Transceiver::readReg) */
+template <uint8_t Addr, uint8_t Width, uint16_t Mask, reg_access_t Access, conv_channel_t Channel = CONV_RAW>
+struct urtx_reg_t {
+	static constexpr uint8_t addr = Addr;
+	static constexpr uint8_t width = Width;							// bytes, most significant first
+	static constexpr uint16_t mask = Mask;							// bits that carry the value
+	static constexpr conv_channel_t channel = Channel;				// conversion of a reading (see Conversions.h)
+	static constexpr bool readable = Access & REG_R;
+	static constexpr bool writable = Access & REG_W;
+	static constexpr bool fifo = (Addr == TX_DATA || Addr == BEACON_DATA || Addr == RX_DATA);
+	static constexpr bool shadowed = Addr <= PTT_OFF_DELAY_GMSK && !fifo && Addr != RESET;
+
+	static_assert(Width == 1 || Width == 2, "registers are one or two bytes wide");
+	static_assert(Width == 2 || Mask <= 0xFF, "the mask is wider than the register");
+	static_assert(Addr + Width <= URTX_REG_END, "the register runs past the end of the map");
+	static_assert(!fifo || Width == 1, "FIFO registers are accessed a byte at a time");
+
+	/* the value of the register, taken from its bytes as read off the bus */
+	static constexpr uint16_t decode(const uint8_t* raw) {
+		return ((Width == 2) ? (((uint16_t)raw[0] << 8) | raw[1]) : raw[0]) & Mask;
+	}
+};
+
+using reg_modem_config				= urtx_reg_t<MODEM_CONFIG,					1,		0x03,				REG_RW>;
+using reg_ax25_tx_delay				= urtx_reg_t<AX25_TX_DELAY,					1,		0xFF,				REG_RW>;
+using reg_sync_bytes				= urtx_reg_t<SYNC_BYTES,					1,		0xFF,				REG_RW>;
+using reg_tx_data					= urtx_reg_t<TX_DATA,						1,		0xFF,				REG_W>;
+using reg_beacon_ctrl				= urtx_reg_t<BEACON_CTRL,					1,		0x01,				REG_RW>;		// bit 1 (clear) reads back as 0
+using reg_beacon_data				= urtx_reg_t<BEACON_DATA,					1,		0xFF,				REG_W>;
+using reg_pa_power_lvl				= urtx_reg_t<PA_POWER_LVL,					1,		0x03,				REG_RW>;
+using reg_rx_offset					= urtx_reg_t<RX_OFFSET,						2,		0x03FF,				REG_RW>;
+using reg_tx_offset					= urtx_reg_t<TX_OFFSET,						2,		0x01FF,				REG_RW>;
+using reg_initial_i2c_timeout		= urtx_reg_t<INITIAL_I2C_TIMEOUT,			1,		0xFF,				REG_RW>;
+using reg_recurring_i2c_timeout		= urtx_reg_t<RECURRING_I2C_TIMEOUT,			1,		0xFF,				REG_RW>;
+using reg_debug						= urtx_reg_t<DEBUG_REG,						1,		0x07,				REG_RW>;
+using reg_reset						= urtx_reg_t<RESET,							1,		0xFF,				REG_W>;
+using reg_transparent_mode			= urtx_reg_t<TRANSPARENT_MODE,				1,		0x0F,				REG_RW>;
+using reg_almost_empty_threshold	= urtx_reg_t<ALMOST_EMPTY_THRESHOLD,		2,		0x1FFF,				REG_RW>;
+using reg_ptt_off_delay_afsk		= urtx_reg_t<PTT_OFF_DELAY_AFSK,			1,		0xFF,				REG_RW>;
+using reg_ptt_off_delay_gmsk		= urtx_reg_t<PTT_OFF_DELAY_GMSK,			1,		0xFF,				REG_RW>;
+using reg_firmware_version			= urtx_reg_t<FIRMWARE_VERSION,				1,		0xFF,				REG_R>;
+using reg_ready_signals				= urtx_reg_t<READY_SIGNALS,					1,		0x03,				REG_R>;
+using reg_rx_buffer_cnt				= urtx_reg_t<RX_BUFFER_CNT,					2,		0xFFFF,				REG_R>;
+using reg_rx_data					= urtx_reg_t<RX_DATA,						1,		0xFF,				REG_R>;
+using reg_tx_buffer_free_slots		= urtx_reg_t<TX_BUFFER_FREE_SLOTS,			2,		0xFFFF,				REG_R>;
+using reg_rx_crc_fail_cntr			= urtx_reg_t<RX_CRC_FAIL_CNTR,				2,		0xFFFF,				REG_R>;
+using reg_rx_packet_cntr			= urtx_reg_t<RX_PACKET_CNTR,				2,		0xFFFF,				REG_R>;
+using reg_rx_full_fail_cntr			= urtx_reg_t<RX_FULL_FAIL_CNTR,				1,		0xFF,				REG_R>;
+using reg_tx_buffer_overrun			= urtx_reg_t<TX_BUFFER_OVERRUN,				2,		0xFFFF,				REG_R>;
+using reg_frequency_lock			= urtx_reg_t<FREQUENCY_LOCK,				1,		0x03,				REG_R>;
+using reg_dtmf						= urtx_reg_t<DTMF,							1,		0xFF,				REG_R>;
+using reg_rssi						= urtx_reg_t<RSSI,							2,		RSSI_MASK,			REG_R,	CONV_RSSI>;
+using reg_smps_temp					= urtx_reg_t<SMPS_TEMP,						1,		0xFF,				REG_R>;
+using reg_pa_temp					= urtx_reg_t<PA_TEMP,						1,		0xFF,				REG_R>;
+using reg_current_3v3				= urtx_reg_t<CURRENT_3V3,					2,		0xFFFF,				REG_R,	CONV_CURRENT_3V3>;
+using reg_voltage_3v3				= urtx_reg_t<VOLTAGE_3V3,					2,		BUS_VOLTAGE_MASK,	REG_R,	CONV_BUS_VOLTAGE>;
+using reg_current_5v				= urtx_reg_t<CURRENT_5V,					2,		0xFFFF,				REG_R,	CONV_CURRENT_5V>;
+using reg_voltage_5v				= urtx_reg_t<VOLTAGE_5V,					2,		BUS_VOLTAGE_MASK,	REG_R,	CONV_BUS_VOLTAGE>;
+using reg_pa_power_forward			= urtx_reg_t<PA_POWER_FORWARD,				2,		PA_POWER_MASK,		REG_R,	CONV_PA_POWER>;
+using reg_pa_power_reverse			= urtx_reg_t<PA_POWER_REVERSE,				2,		PA_POWER_MASK,		REG_R,	CONV_PA_POWER>;
+
+
+/*************************** Bursts ****************************/
+
+template <class... Regs>
+constexpr bool urtx_contiguous() {
+	const uint8_t addr[] = {Regs::addr...};
+	const uint8_t width[] = {Regs::width...};
+	for (unsigned i = 1; i < sizeof...(Regs); i++) {
+		if (addr[i] != addr[i-1] + width[i-1]) return false;
+	}
+	return true;
+}
+
+/* consecutive registers accessed in one transfer; a gap, a FIFO or a register of the wrong kind does not compile */
+template <class First, class... Rest>
+struct urtx_burst_t {
+	static constexpr uint8_t addr = First::addr;
+	static constexpr uint8_t len = (First::width + ... + Rest::width);
+	static constexpr bool readable = (First::readable && ... && Rest::readable);
+	static constexpr bool writable = (First::writable && ... && Rest::writable);
+
+	static_assert(urtx_contiguous<First, Rest...>(), "the registers of a burst must be consecutive");
+	static_assert(!(First::fifo || ... || Rest::fifo), "a FIFO register would swallow the rest of the burst");
+
+	template <class Reg>
+	static constexpr bool contains = (std::is_same<Reg, First>::value || ... || std::is_same<Reg, Rest>::value);
+
+	static constexpr bool covers(int reg) {
+		return reg >= addr && reg < addr + len;
+	}
+
+	/* the value of one of the registers, taken from the burst as read off the bus */
+	template <class Reg>
+	static constexpr uint16_t decode(const uint8_t* block) {
+		static_assert(contains<Reg>, "the register is not part of this burst");
+		return Reg::decode(block + (Reg::addr - addr));
+	}
+};
+
+/* every sensor reading (see UHF_Transceiver::getTelemetry) */
+using urtx_telemetry_t = urtx_burst_t<reg_rssi, reg_smps_temp, reg_pa_temp, reg_current_3v3, reg_voltage_3v3,
+									  reg_current_5v, reg_voltage_5v, reg_pa_power_forward, reg_pa_power_reverse>;
+
+static_assert(urtx_telemetry_t::addr + urtx_telemetry_t::len == URTX_REG_END, "the telemetry burst ends with the map");
+
+#endif // URTX_REGISTERS
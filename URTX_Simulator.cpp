@@ -0,0 +1,386 @@
+ /****************************************************************************
+ * URTX_Simulator.cpp
+ *
+ * @hardware    : UHF Transceiver (simulated)
+ * @manual      : USM-01-00097 User Manual Rev. C
+ * @about       : An in-process model of the transceiver's register map,
+ *                FIFOs and timing, used in place of lsquaredc so that the
+ *                radio stack can run without the flight hardware.
+ * @author      : Carlos Carrasquillo
+ * @contact     : c.carrasquillo@ufl.edu
+ * @date        : October 17, 2026
+ * @modified    : October 17, 2026
+ *
+ * Property of ADAMUS lab, University of Florida.
+ ****************************************************************************/
+
+#include <time.h>
+#include <string.h>
+#include <iostream>
+#include "URTX_Simulator.h"
+
+#define NS_PER_SEC		1000000000ULL
+
+static uint64_t monotonic_ns() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static bool is_fifo(uint8_t reg) {
+	/* FIFO registers do not auto-increment the register pointer */
+	return reg == TX_DATA || reg == BEACON_DATA || reg == RX_DATA;
+}
+
+URTX_Simulator::URTX_Simulator(const sim_config_t& config) {
+	this->config = config;
+	memset(&stats, 0, sizeof(stats));
+	clock_ns = 0;
+	start_ns = monotonic_ns();
+	reset();
+}
+
+void URTX_Simulator::configure(const sim_config_t& config) {
+	advanceModem();
+	this->config = config;
+}
+
+void URTX_Simulator::reset() {
+	memset(regs, 0, sizeof(regs));
+	pointer = 0;
+	regs[MODEM_CONFIG] = MODEM_GMSK_DOWN;
+	regs[AX25_TX_DELAY] = 0x0A;
+	regs[PA_POWER_LVL] = PA_LVL_27;
+	regs[INITIAL_I2C_TIMEOUT] = 1;
+	regs[RECURRING_I2C_TIMEOUT] = 10;
+	regs[TRANSPARENT_MODE] = AX25_MODE;
+	put16(ALMOST_EMPTY_THRESHOLD, SIM_DEFAULT_THRESHOLD);
+	regs[PTT_OFF_DELAY_AFSK] = 10;
+	regs[PTT_OFF_DELAY_GMSK] = 1;
+	regs[FIRMWARE_VERSION] = 0x13;
+
+	/* sensor readings of a transceiver idling at room temperature */
+	put16(RSSI, 0x0400);
+	regs[SMPS_TEMP] = 30;
+	regs[PA_TEMP] = 32;
+	put16(CURRENT_3V3, 20000);					// 60 mA
+	put16(VOLTAGE_3V3, 825);					// 3.3 V
+	put16(CURRENT_5V, 1000);					// 62 mA
+	put16(VOLTAGE_5V, 1250);					// 5.0 V
+	put16(PA_POWER_FORWARD, 0x0800);
+	put16(PA_POWER_REVERSE, 0x0100);
+
+	beacon_len = 0;
+	tx_fifo.clear();
+	rx_fifo.clear();
+	rx_pending.clear();
+	rx_crc_fail_cnt = 0;
+	rx_packet_cnt = 0;
+	tx_overrun_cnt = 0;
+	rx_full_fail_cnt = 0;
+	modem_ns = now();
+	tx_bits = 0;
+	rx_lock_ns = modem_ns + SIM_LOCK_TIME_NS;
+	tx_lock_ns = modem_ns + SIM_LOCK_TIME_NS;
+}
+
+void URTX_Simulator::idle(uint64_t ns) {
+	if (config.realtime) {
+		struct timespec ts = {(time_t)(ns / NS_PER_SEC), (long)(ns % NS_PER_SEC)};
+		nanosleep(&ts, NULL);
+	} else {
+		clock_ns += ns;
+	}
+}
+
+uint64_t URTX_Simulator::now() {
+	if (config.realtime) return monotonic_ns() - start_ns;
+	return clock_ns;
+}
+
+void URTX_Simulator::put16(uint8_t reg, uint16_t val) {
+	regs[reg] = (val >> 8) & 0xFF;				// the transceiver is big endian
+	regs[reg+1] = val & 0xFF;
+}
+
+void URTX_Simulator::advanceBus(uint32_t bytes) {
+	uint64_t bits = (uint64_t)bytes * SIM_BITS_PER_BYTE + SIM_START_STOP_BITS;
+	uint64_t ns = bits * NS_PER_SEC / config.bus_hz;
+
+	stats.transactions++;
+	stats.bus_bytes += bytes;
+	stats.bus_time_ns += ns;
+
+	if (config.realtime) {
+		struct timespec ts = {(time_t)(ns / NS_PER_SEC), (long)(ns % NS_PER_SEC)};
+		nanosleep(&ts, NULL);
+	} else {
+		clock_ns += ns;
+	}
+}
+
+void URTX_Simulator::advanceModem() {
+	uint64_t t = now();
+	uint64_t dt = t - modem_ns;
+	modem_ns = t;
+
+	/* downlink: the modem drains one byte every 8 bit periods while there is data */
+	if (tx_fifo.empty()) {
+		stats.tx_empty_ns += dt;
+		tx_bits = 0;
+	} else {
+		tx_bits += dt * config.downlink_bps;
+		uint64_t drainable = tx_bits / (8 * NS_PER_SEC);
+
+		if (drainable >= tx_fifo.size()) {
+			uint64_t busy_ns = (tx_fifo.size() * 8 * NS_PER_SEC) / config.downlink_bps;
+			stats.tx_empty_ns += (dt > busy_ns) ? dt - busy_ns : 0;
+			drainable = tx_fifo.size();
+			tx_bits = 0;
+		} else {
+			tx_bits -= drainable * 8 * NS_PER_SEC;
+		}
+
+		downlink.append(tx_fifo.begin(), tx_fifo.begin() + drainable);
+		tx_fifo.erase(tx_fifo.begin(), tx_fifo.begin() + drainable);
+		stats.downlinked += drainable;
+
+		if (downlink.size() > SIM_CAPTURE_LEN) downlink.erase(0, downlink.size() - SIM_CAPTURE_LEN);
+	}
+
+	/* uplink: packets land in the RX FIFO once they have been fully received */
+	while (!rx_pending.empty() && rx_pending.front().arrival_ns <= t) {
+		const std::string& data = rx_pending.front().data;
+		if (rx_fifo.size() + data.size() > SIM_RX_FIFO_LEN) {
+			rx_full_fail_cnt++;
+		} else {
+			rx_fifo.insert(rx_fifo.end(), data.begin(), data.end());
+			rx_packet_cnt++;
+			stats.uplinked += data.size();
+		}
+		rx_pending.pop_front();
+	}
+}
+
+void URTX_Simulator::updateStatus() {
+	uint16_t threshold = (regs[ALMOST_EMPTY_THRESHOLD] << 8) | regs[ALMOST_EMPTY_THRESHOLD+1];
+	bool tx_ready = tx_fifo.size() < threshold;
+	bool rx_ready = !rx_fifo.empty();
+
+	regs[READY_SIGNALS] = (rx_ready << 1) | (tx_ready << 0);
+	put16(RX_BUFFER_CNT, rx_fifo.size());
+	put16(TX_BUFFER_FREE_SLOTS, SIM_TX_FIFO_LEN - tx_fifo.size());
+	put16(RX_CRC_FAIL_CNTR, rx_crc_fail_cnt);
+	put16(RX_PACKET_CNTR, rx_packet_cnt);
+	regs[RX_FULL_FAIL_CNTR] = rx_full_fail_cnt;
+	put16(TX_BUFFER_OVERRUN, tx_overrun_cnt);
+	regs[FREQUENCY_LOCK] = ((now() >= tx_lock_ns) << 1) | ((now() >= rx_lock_ns) << 0);
+}
+
+uint8_t URTX_Simulator::readRegister(uint8_t reg) {
+	if (reg == RX_DATA) {
+		if (rx_fifo.empty()) return 0xFF;		// pp. 24
+		uint8_t data = rx_fifo.front();
+		rx_fifo.pop_front();
+		return data;
+	}
+	return regs[reg];
+}
+
+void URTX_Simulator::writeRegister(uint8_t reg, uint8_t data) {
+	switch (reg) {
+		case TX_DATA:
+			if (tx_fifo.size() < SIM_TX_FIFO_LEN) tx_fifo.push_back(data);
+			else 								  tx_overrun_cnt++;
+			break;
+		case BEACON_CTRL:
+			if (data & 0x02) beacon_len = 0;	// the clear bit is self-clearing
+			regs[reg] = data & ~0x02;
+			break;
+		case BEACON_DATA:
+			if (beacon_len < BEACON_DATA_BUFFER_LEN) beacon[beacon_len++] = data;
+			break;
+		case RESET:
+			reset();
+			break;
+		case RX_OFFSET:
+		case RX_OFFSET+1:
+			if (regs[reg] != data) rx_lock_ns = now() + SIM_LOCK_TIME_NS;
+			regs[reg] = data;
+			break;
+		case TX_OFFSET:
+		case TX_OFFSET+1:
+			if (regs[reg] != data) tx_lock_ns = now() + SIM_LOCK_TIME_NS;
+			regs[reg] = data;
+			break;
+		default:
+			if (reg < FIRMWARE_VERSION) regs[reg] = data;	// everything from FIRMWARE_VERSION up is read-only
+			break;
+	}
+}
+
+int URTX_Simulator::transfer(const uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data) {
+	uint32_t bytes = 0;
+	for (uint32_t i = 0; i < sequence_length; i++) {
+		if (sequence[i] != I2C_RESTART) bytes++;
+	}
+
+	advanceBus(bytes);
+	advanceModem();
+	updateStatus();
+
+	/* every segment starts with an address byte; the first byte written sets the register pointer */
+	uint32_t i = 0;
+	while (i < sequence_length) {
+		uint8_t address = sequence[i++];
+		bool reading = address & 1;
+		bool pointer_set = reading;
+		if ((address >> 1) != TRANSCEIVER_I2C_ADDR) return -1;		// nobody ACKs the address
+
+		while (i < sequence_length && sequence[i] != I2C_RESTART) {
+			uint16_t element = sequence[i++];
+			if (reading) {
+				*received_data++ = readRegister(pointer);
+				if (!is_fifo(pointer)) pointer++;
+			} else if (!pointer_set) {
+				pointer = element;
+				pointer_set = true;
+			} else {
+				writeRegister(pointer, element);
+				if (!is_fifo(pointer)) pointer++;
+			}
+		}
+		i++;														// skip the RESTART
+	}
+
+	return 0;
+}
+
+int URTX_Simulator::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n) {
+	advanceBus(n + 2);												// address + register + data
+	advanceModem();
+	updateStatus();
+	if (address != TRANSCEIVER_I2C_ADDR) return -1;
+
+	pointer = reg;
+	for (uint32_t i = 0; i < n; i++) {
+		writeRegister(pointer, data[i]);
+		if (!is_fifo(pointer)) pointer++;
+	}
+	return 0;
+}
+
+int URTX_Simulator::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n) {
+	advanceBus(n + 3);												// address + register + address + data
+	advanceModem();
+	updateStatus();
+	if (address != TRANSCEIVER_I2C_ADDR) return -1;
+
+	pointer = reg;
+	for (uint32_t i = 0; i < n; i++) {
+		data[i] = readRegister(pointer);
+		if (!is_fifo(pointer)) pointer++;
+	}
+	return 0;
+}
+
+int URTX_Simulator::injectPacket(const uint8_t* data, int n, uint64_t delay_ns) {
+	uint64_t start = now() + delay_ns;
+	if (!rx_pending.empty() && rx_pending.back().arrival_ns > start) start = rx_pending.back().arrival_ns;
+
+	uint64_t airtime = ((uint64_t)n * 8 * NS_PER_SEC) / config.uplink_bps;
+	rx_pending.push_back({start + airtime, std::string((const char*)data, n)});
+	return 0;
+}
+
+std::string URTX_Simulator::readDownlink() {
+	advanceModem();
+	std::string out;
+	out.swap(downlink);
+	return out;
+}
+
+std::string URTX_Simulator::getBeacon() {
+	return std::string((const char*)beacon, beacon_len);
+}
+
+const sim_stats_t& URTX_Simulator::getStats() const {
+	return stats;
+}
+
+void URTX_Simulator::printStats() {
+	advanceModem();
+	double elapsed = now() / 1e9;
+	double bus_time = stats.bus_time_ns / 1e9;
+
+	std::cout << std::dec;
+	std::cout << "Simulated URTX (" << config.bus_hz / 1000 << " kHz bus, " << config.downlink_bps << " bps downlink):" << std::endl;
+	std::cout << "\tElapsed: " << elapsed << " s, Bus Busy: " << bus_time << " s" << std::endl;
+	std::cout << "\tTransactions: " << stats.transactions << ", Bus Bytes: " << stats.bus_bytes << std::endl;
+	std::cout << "\tDownlinked: " << stats.downlinked << " bytes (" << (elapsed > 0 ? stats.downlinked * 8 / elapsed : 0) << " bps), "
+			  << "Modem Idle: " << stats.tx_empty_ns / 1e9 << " s" << std::endl;
+	std::cout << "\tUplinked: " << stats.uplinked << " bytes, Packets: " << rx_packet_cnt << ", Dropped: " << static_cast<int>(rx_full_fail_cnt) << std::endl;
+}
+
+URTX_Simulator& urtx_simulator() {
+	static URTX_Simulator simulator({SIM_BUS_100KHZ, SIM_MODEM_9600BPS, SIM_MODEM_9600BPS, false});
+	return simulator;
+}
+
+
+/************************ Sim Session *************************/
+
+Sim_Session::Sim_Session(uint8_t bus) {
+	this->bus = bus;
+	resetStats();
+}
+
+int Sim_Session::transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool) {
+	int status = urtx_simulator().transfer(sequence, sequence_length, received_data);
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+int Sim_Session::writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool) {
+	int status = urtx_simulator().writeBlock(address, reg, data, n);
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+int Sim_Session::readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool) {
+	int status = urtx_simulator().readBlock(address, reg, data, n);
+
+	if (status < 0) stats.failures++;
+	else 			stats.transactions++;
+
+	return status;
+}
+
+void Sim_Session::idle(uint64_t ns) {
+	urtx_simulator().idle(ns);
+}
+
+bool Sim_Session::isOpen() const {
+	return true;
+}
+
+const i2c_stats_t& Sim_Session::getStats() const {
+	return stats;
+}
+
+void Sim_Session::resetStats() {
+	stats = {0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+void Sim_Session::printStats() {
+	std::cout << std::dec;
+	std::cout << "I2C Bus " << static_cast<int>(bus) << " Statistics (simulated):" << std::endl;
+	std::cout << "\tTransactions: " << stats.transactions << ", Failures: " << stats.failures << std::endl;
+	urtx_simulator().printStats();
+}
@@ -0,0 +1,143 @@
+/****************************************************************************
+* URTX_Simulator.h
+*
+* @hardware    : UHF Transceiver (simulated)
+* @manual      : USM-01-00097 User Manual Rev. C
+* @about       : An in-process model of the transceiver's register map,
+*                FIFOs and timing, used in place of lsquaredc so that the
+*                radio stack can run without the flight hardware.
+* @author      : Carlos Carrasquillo
+* @contact     : c.carrasquillo@ufl.edu
+* @date        : October 17, 2026
+* @modified    : October 17, 2026
+*
+* Property of ADAMUS lab, University of Florida.
+****************************************************************************/
+
+#ifndef URTX_SIMULATOR
+#define URTX_SIMULATOR
+
+
+/************************** Includes **************************/
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <string>
+#include "URTX_Registers.h"
+#include "I2C_Session.h"
+
+
+/*************************** Defines ***************************/
+
+#define SIM_BUS_100KHZ			100000
+#define SIM_BUS_400KHZ			400000
+#define SIM_MODEM_1200BPS		1200
+#define SIM_MODEM_9600BPS		9600
+
+#define SIM_TX_FIFO_LEN			2048	// bytes
+#define SIM_RX_FIFO_LEN			2048	// bytes
+#define SIM_DEFAULT_THRESHOLD	1024	// ALMOST_EMPTY_THRESHOLD after a reset
+#define SIM_LOCK_TIME_NS		3000000	// synthesizer settling time after a reset or a frequency change
+#define SIM_CAPTURE_LEN			65536	// most downlinked bytes kept for inspection
+#define SIM_BITS_PER_BYTE		9		// 8 data bits + ACK on the I2C bus
+#define SIM_START_STOP_BITS		2		// START and STOP conditions, counted as one bit time each
+
+struct sim_config_t {
+	uint32_t bus_hz;					// I2C clock (SIM_BUS_100KHZ or SIM_BUS_400KHZ)
+	uint32_t downlink_bps;				// rate at which the TX FIFO drains
+	uint32_t uplink_bps;				// rate at which injected packets arrive in the RX FIFO
+	bool realtime;						// sleep for the modelled bus time and use the wall clock
+};
+
+struct sim_stats_t {
+	uint64_t transactions;				// I2C transactions addressed to the transceiver
+	uint64_t bus_bytes;					// bytes clocked over the bus (addresses included)
+	uint64_t bus_time_ns;				// time spent on the bus
+	uint64_t downlinked;				// bytes drained from the TX FIFO by the modem
+	uint64_t uplinked;					// bytes placed in the RX FIFO
+	uint64_t tx_empty_ns;				// time the modem sat idle with an empty TX FIFO
+};
+
+
+/************************* Simulator **************************/
+
+class URTX_Simulator {
+private:
+	struct uplink_t {
+		uint64_t arrival_ns;			// time at which the packet has been fully received
+		std::string data;
+	};
+
+	sim_config_t config;
+	sim_stats_t stats;
+	uint8_t regs[256];
+	uint8_t pointer;					// register pointer, set by the first byte of a write
+	uint8_t beacon[BEACON_DATA_BUFFER_LEN];
+	int beacon_len;
+
+	std::deque<uint8_t> tx_fifo, rx_fifo;
+	std::deque<uplink_t> rx_pending;	// uplinked packets still on the air
+	std::string downlink;
+
+	uint16_t rx_crc_fail_cnt, rx_packet_cnt, tx_overrun_cnt;
+	uint8_t rx_full_fail_cnt;
+
+	std::atomic<uint64_t> clock_ns;		// simulated time (virtual mode), also advanced by idle() outside the arbiter
+	uint64_t start_ns;					// wall clock at construction (realtime mode)
+	uint64_t modem_ns;					// time up to which the modem has been simulated
+	uint64_t tx_bits;					// fractional progress of the modem, in bit-nanoseconds
+	uint64_t rx_lock_ns, tx_lock_ns;	// time at which each synthesizer locks
+
+	void advanceBus(uint32_t bytes);	// accounts for the time a transaction occupies the bus
+	void advanceModem();				// drains the TX FIFO and fills the RX FIFO up to the current time
+	void updateStatus();				// refreshes the read-only status and counter registers
+	uint8_t readRegister(uint8_t reg);
+	void writeRegister(uint8_t reg, uint8_t data);
+	void put16(uint8_t reg, uint16_t val);
+
+public:
+	explicit URTX_Simulator(const sim_config_t& config);
+	void configure(const sim_config_t& config);					// changes the bus and modem rates
+	void reset();												// restores every register to its power-on value
+
+	int transfer(const uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data);	// executes an lsquaredc sequence
+	int writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n);	// single-message write of consecutive registers
+	int readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n);			// pointer write + repeated-start read
+	int injectPacket(const uint8_t* data, int n, uint64_t delay_ns = 0);	// queues an uplinked packet for the RX FIFO, on the air after delay_ns
+	std::string readDownlink();									// fetches (and clears) the bytes the modem has transmitted
+	std::string getBeacon();									// fetches the contents of the beacon buffer
+	void idle(uint64_t ns);										// lets time pass without a transaction
+	uint64_t now();												// current simulated time in nanoseconds
+
+	const sim_stats_t& getStats() const;
+	void printStats();
+};
+
+URTX_Simulator& urtx_simulator();								// the transceiver shared by every Sim_Session
+
+
+/*********************** Sim Session **************************/
+
+/* Drop-in replacement for I2C_Session that routes transfers to the simulator. */
+class Sim_Session {
+private:
+	uint8_t bus;
+	i2c_stats_t stats;
+
+public:
+	explicit Sim_Session(uint8_t bus = 0);
+	Sim_Session(const Sim_Session&) = delete;
+	Sim_Session& operator=(const Sim_Session&) = delete;
+
+	int transfer(uint16_t* sequence, uint32_t sequence_length, uint8_t* received_data, bool retry = true);	// the simulated bus never needs a reconnect
+	int writeBlock(uint8_t address, uint8_t reg, const uint8_t* data, uint32_t n, bool retry = true);
+	int readBlock(uint8_t address, uint8_t reg, uint8_t* data, uint32_t n, bool retry = true);
+	void idle(uint64_t ns);
+	bool isOpen() const;
+	const i2c_stats_t& getStats() const;
+	void resetStats();
+	void printStats();
+};
+
+#endif // URTX_SIMULATOR
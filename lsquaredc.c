@@ -25,6 +25,7 @@
 #include <sys/stat.h>
 #include <sys/ioctl.h>
 #include <fcntl.h>
+#include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -35,7 +36,7 @@
 
 #define DEVICE_NAME_LENGTH 11   /* example: "/dev/i2c-1" + the terminating 0 */
 
-static uint32_t check_i2c_functionality(handle) {
+static uint32_t check_i2c_functionality(int handle) {
     unsigned long funcs;
     if(ioctl(handle, I2C_FUNCS, &funcs) < 0) {
         return 0;
@@ -55,7 +56,30 @@ int i2c_open(uint8_t bus) {
     if(bus > 9) return -1;        /* sanity check */
     snprintf(device_name, DEVICE_NAME_LENGTH, "/dev/i2c-%d", bus);
     if((handle = open(device_name, O_RDWR)) < 0) return handle;
-    if(!check_i2c_functionality(handle)) return -1;
+    if(!check_i2c_functionality(handle)) {
+        close(handle);
+        return -1;
+    }
+    return handle;
+}
+
+
+/*
+   Same as i2c_open(), but reports the full I2C_FUNCS mask of the adapter in funcs. Adapters that only support SMBus
+   I2C-block transfers are accepted as well.
+*/
+int i2c_open_funcs(uint8_t bus, unsigned long *funcs) {
+    char device_name[DEVICE_NAME_LENGTH];
+    int handle;
+    *funcs = 0;
+    if(bus > 9) return -1;        /* sanity check */
+    snprintf(device_name, DEVICE_NAME_LENGTH, "/dev/i2c-%d", bus);
+    if((handle = open(device_name, O_RDWR)) < 0) return handle;
+    if(ioctl(handle, I2C_FUNCS, funcs) < 0 ||
+       !(*funcs & (I2C_FUNC_I2C | I2C_FUNC_SMBUS_I2C_BLOCK))) {
+        close(handle);
+        return -1;
+    }
     return handle;
 }
 
@@ -81,36 +105,19 @@ static uint32_t count_segments(uint16_t *sequence, uint32_t sequence_length) {
 
 
 /*
-  Sends a command/data sequence that can include restarts, writes and reads. Every transmission begins with a START,
-  and ends with a STOP so you do not have to specify that.
-  sequence is the I2C operation sequence that should be performed. It can include any number of writes, restarts and
-  reads. Note that the sequence is composed of uint16_t, not uint8_t. This is because we have to support out-of-band
-  signalling of I2C_RESTART and I2C_READ operations, while still passing through 8-bit data.
-  sequence_length is the number of sequence elements (not bytes). Sequences of arbitrary length are supported, but
-  there is an upper limit on the number of segments (restarts): no more than 42. The minimum sequence length is
-  (rather obviously) 2.
-  received_data should point to a buffer that can hold as many bytes as there are I2C_READ operations in the
-  sequence. If there are no reads, 0 can be passed, as this parameter will not be used.
+  Fills out the message structures for the sequence and performs the transfer. messages must hold number_of_segments
+  entries and msg_buf must hold sequence_length bytes.
 */
-int i2c_send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data) {
+static int send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data,
+                         uint32_t number_of_segments, struct i2c_msg *messages, uint8_t *msg_buf) {
     struct i2c_rdwr_ioctl_data message_sequence;
-    uint32_t number_of_segments = count_segments(sequence, sequence_length);
-    struct i2c_msg *messages = malloc(number_of_segments * sizeof(struct i2c_msg));
     struct i2c_msg *current_message = messages;
-    /* msg_buf needs to hold all *bytes written* in the entire sequence. Since it is difficult to estimate that number
-       without processing the sequence, we make an upper-bound guess: sequence_length. Yes, this is inefficient, but
-       optimizing this doesn't seem to be worth the effort. */
-    uint8_t *msg_buf = malloc(sequence_length); /* certainly no more than that */
     uint8_t *msg_cur_buf_ptr = msg_buf;
     uint8_t *msg_cur_buf_base;
     uint32_t msg_cur_buf_size;
     uint8_t address;
     uint8_t rw;
     uint32_t i;
-    int result = -1;
-
-    if(sequence_length < 2) goto i2c_send_sequence_cleanup;
-    if((number_of_segments > I2C_RDRW_IOCTL_MAX_MSGS)) goto i2c_send_sequence_cleanup;
 
     address = sequence[0];        /* the first byte is always an address */
     rw = address & 1;
@@ -151,7 +158,35 @@ int i2c_send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length,
     message_sequence.msgs = messages;
     message_sequence.nmsgs = number_of_segments;
 
-    result = ioctl(handle, I2C_RDWR, (unsigned long)(&message_sequence));
+    return ioctl(handle, I2C_RDWR, (unsigned long)(&message_sequence));
+}
+
+
+/*
+  Sends a command/data sequence that can include restarts, writes and reads. Every transmission begins with a START,
+  and ends with a STOP so you do not have to specify that.
+  sequence is the I2C operation sequence that should be performed. It can include any number of writes, restarts and
+  reads. Note that the sequence is composed of uint16_t, not uint8_t. This is because we have to support out-of-band
+  signalling of I2C_RESTART and I2C_READ operations, while still passing through 8-bit data.
+  sequence_length is the number of sequence elements (not bytes). Sequences of arbitrary length are supported, but
+  there is an upper limit on the number of segments (restarts): no more than 42. The minimum sequence length is
+  (rather obviously) 2.
+  received_data should point to a buffer that can hold as many bytes as there are I2C_READ operations in the
+  sequence. If there are no reads, 0 can be passed, as this parameter will not be used.
+*/
+int i2c_send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data) {
+    uint32_t number_of_segments = count_segments(sequence, sequence_length);
+    struct i2c_msg *messages = malloc(number_of_segments * sizeof(struct i2c_msg));
+    /* msg_buf needs to hold all *bytes written* in the entire sequence. Since it is difficult to estimate that number
+       without processing the sequence, we make an upper-bound guess: sequence_length. Yes, this is inefficient, but
+       optimizing this doesn't seem to be worth the effort. */
+    uint8_t *msg_buf = malloc(sequence_length); /* certainly no more than that */
+    int result = -1;
+
+    if(sequence_length < 2) goto i2c_send_sequence_cleanup;
+    if((number_of_segments > I2C_RDRW_IOCTL_MAX_MSGS)) goto i2c_send_sequence_cleanup;
+
+    result = send_sequence(handle, sequence, sequence_length, received_data, number_of_segments, messages, msg_buf);
 
     i2c_send_sequence_cleanup:
     free(msg_buf);
@@ -161,6 +196,91 @@ int i2c_send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length,
 }
 
 
+/*
+  Same as i2c_send_sequence(), but the message structures and the write buffer live in a caller-provided arena, so
+  no memory is allocated. Sequences longer than I2C_MAX_SEQUENCE_LEN or with more than I2C_MAX_SEGMENTS segments
+  are rejected.
+*/
+int i2c_send_sequence_arena(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data,
+                            struct i2c_arena *arena) {
+    uint32_t number_of_segments;
+
+    if(sequence_length < 2 || sequence_length > I2C_MAX_SEQUENCE_LEN) return -1;
+    number_of_segments = count_segments(sequence, sequence_length);
+    if(number_of_segments > I2C_MAX_SEGMENTS) return -1;
+
+    return send_sequence(handle, sequence, sequence_length, received_data, number_of_segments, arena->messages,
+                         arena->msg_buf);
+}
+
+
+/*
+   Block transfers to/from consecutive registers that skip the 16-bit sequence encoding. They take the 7-bit address.
+   The SMBus and plain write() paths act on the address selected with i2c_set_slave().
+*/
+int i2c_set_slave(int handle, uint8_t address) {
+    return ioctl(handle, I2C_SLAVE, (unsigned long)address);
+}
+
+int i2c_smbus_write_block(int handle, uint8_t reg, const uint8_t *data, uint8_t n) {
+    union i2c_smbus_data block;
+    struct i2c_smbus_ioctl_data args;
+
+    if(n > I2C_SMBUS_BLOCK_MAX) return -1;
+    block.block[0] = n;
+    memcpy(&block.block[1], data, n);
+
+    args.read_write = I2C_SMBUS_WRITE;
+    args.command = reg;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &block;
+    return ioctl(handle, I2C_SMBUS, &args);
+}
+
+int i2c_smbus_read_block(int handle, uint8_t reg, uint8_t *data, uint8_t n) {
+    union i2c_smbus_data block;
+    struct i2c_smbus_ioctl_data args;
+
+    if(n > I2C_SMBUS_BLOCK_MAX) return -1;
+    block.block[0] = n;
+
+    args.read_write = I2C_SMBUS_READ;
+    args.command = reg;
+    args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    args.data = &block;
+    if(ioctl(handle, I2C_SMBUS, &args) < 0) return -1;
+
+    memcpy(data, &block.block[1], n);
+    return 0;
+}
+
+/* register pointer and data go out in a single write(); buf must hold n+1 bytes */
+int i2c_write_raw(int handle, uint8_t reg, const uint8_t *data, uint32_t n, uint8_t *buf) {
+    buf[0] = reg;
+    memcpy(&buf[1], data, n);
+    return (write(handle, buf, n + 1) == (ssize_t)(n + 1)) ? 0 : -1;
+}
+
+/* register pointer write followed by a repeated-start read, as one I2C_RDWR with two messages */
+int i2c_write_read(int handle, uint8_t address, uint8_t reg, uint8_t *data, uint32_t n) {
+    struct i2c_msg messages[2];
+    struct i2c_rdwr_ioctl_data message_sequence;
+
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = 1;
+    messages[0].buf = &reg;
+    messages[1].addr = address;
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = n;
+    messages[1].buf = data;
+
+    message_sequence.msgs = messages;
+    message_sequence.nmsgs = 2;
+    return ioctl(handle, I2C_RDWR, (unsigned long)(&message_sequence));
+}
+
+
 /* This function is just a cosmetic wrapper, added for consistency. */
 int i2c_close(int handle) {
     return close(handle);
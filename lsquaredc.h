@@ -22,6 +22,8 @@
   SOFTWARE.
 
   Update: added extern "C"
+  Update: added i2c_send_sequence_arena() for allocation-free transfers
+  Update: added i2c_open_funcs() and the block transfer fast paths
 */
 
 #ifndef LSQUAREDC_H
@@ -32,14 +34,39 @@ extern "C" {
 #endif
 
 #include <stdint.h>
+#include <linux/i2c.h>
 
 #define I2C_RESTART     1<<8    /* repeated start */
 #define I2C_READ		2<<8    /* read a byte */
 
+#define I2C_MAX_SEGMENTS        42      /* I2C_RDRW_IOCTL_MAX_MSGS */
+#define I2C_MAX_SEQUENCE_LEN    512     /* longest sequence accepted by i2c_send_sequence_arena() */
+
+/* caller-provided storage for i2c_send_sequence_arena(), reused across transactions */
+struct i2c_arena {
+    struct i2c_msg messages[I2C_MAX_SEGMENTS];
+    uint8_t msg_buf[I2C_MAX_SEQUENCE_LEN];
+};
+
 int i2c_open(uint8_t bus);
 
 int i2c_send_sequence(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data);
 
+int i2c_send_sequence_arena(int handle, uint16_t *sequence, uint32_t sequence_length, uint8_t *received_data,
+                            struct i2c_arena *arena);
+
+int i2c_open_funcs(uint8_t bus, unsigned long *funcs);
+
+int i2c_set_slave(int handle, uint8_t address);
+
+int i2c_smbus_write_block(int handle, uint8_t reg, const uint8_t *data, uint8_t n);
+
+int i2c_smbus_read_block(int handle, uint8_t reg, uint8_t *data, uint8_t n);
+
+int i2c_write_raw(int handle, uint8_t reg, const uint8_t *data, uint32_t n, uint8_t *buf);
+
+int i2c_write_read(int handle, uint8_t address, uint8_t reg, uint8_t *data, uint32_t n);
+
 int i2c_close(int handle);
 
 #ifdef __cplusplus
@@ -1,6 +1,11 @@
 #include <iostream>
+#include <algorithm>
+#include <fstream>
 #include <string>
+#include <vector>
+#include <atomic>
 #include <unistd.h>
+#include <time.h>
 #include "UHF_Transceiver.h"
 #include "Packager.h"
 #include "Handler.h"
@@ -8,16 +13,465 @@
 #include "Radio.h"
 #include "telecommands.h"
 
+#define BENCH_DEFAULT_SCANS     100
+#define LATENCY_DEFAULT_COMMANDS 20
+#define LATENCY_DEFAULT_GAP_MS  700
+#define DOWNLINK_DEFAULT_KIB    16
+#define DOWNLINK_FILE           "downlink.bin"
+#define DOWNLINK_STEP_BYTES     4
+#define CACHE_DEFAULT_REQUESTS  4
+#define ARQ_DEFAULT_KIB         40                  // the packets have to fit in the simulator's downlink capture
+#define ARQ_DEFAULT_LOSS        10                  // percent of the packets the ground loses
+#define ARQ_BENCH_ROUNDS        8
+#define ARQ_BENCH_RANGES        63                  // ranges per TELECOM_RETRANSMIT (one full data field)
+#define JITTER_DEFAULT_SCANS    1000
+#define JITTER_DEFAULT_PERIOD_MS 10
+#define JITTER_COMMAND_EVERY    50                  // scans between uplinked commands (simulation)
+#define JITTER_BUCKETS          16                  // latency histogram, bucket i counts scans under 2^i us
+#define MALLOC_DEFAULT_SECONDS  15                  // long enough for a health check (see CHECK_HEALTH_EVERY_N_SCANS)
+#define MALLOC_WARMUP_SCANS     100                 // scans before counting starts (buffers that are sized on first use)
+
+
+#ifdef URTX_SIMULATION
+/* every heap allocation in the process (operator new included) passes through these, so the malloc mode can
+   count the ones made while it polls */
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static std::atomic<bool> count_mallocs(false);
+static std::atomic<uint64_t> mallocs(0);
+
+extern "C" void* malloc(size_t size) {
+    if (count_mallocs.load(std::memory_order_relaxed)) mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size) {
+    if (count_mallocs.load(std::memory_order_relaxed)) mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (count_mallocs.load(std::memory_order_relaxed)) mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+/* uplinks a TELECOM_DEBUG_TOGGLE packet to the simulated transceiver, delay_ns from now */
+void injectCommand(uint64_t delay_ns = 0) {
+    uint8_t packet[] = {0x1A, 0xCF, 0x01, TELECOM_DEBUG_TOGGLE, TELECOM_DEBUG_TOGGLE};
+    urtx_simulator().injectPacket(packet, sizeof(packet), delay_ns);
+}
+
+/* uplinks commands at a fixed interval in real time and reports the poller's command-to-response latency */
+int latency(Radio<I2C_Bus>* radio, int num_commands, int gap_ms) {
+    urtx_simulator().configure({SIM_BUS_100KHZ, SIM_MODEM_9600BPS, SIM_MODEM_9600BPS, true});
+    for (int i = 0; i < num_commands; i++) injectCommand((uint64_t)(i + 1) * gap_ms * 1000000ULL);
+
+    radio->getPoller().resetStats();
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds((num_commands + 2) * gap_ms);
+    while (std::chrono::steady_clock::now() < end) {
+        usleep(radio->poll() * 1000);
+    }
+
+    std::cout << std::dec << "Commands: " << num_commands << ", Interval: " << gap_ms << " ms" << std::endl;
+    radio->getPoller().printStats();
+    return 0;
+}
+
+/* uplinks a command (telecommand and parameters) and lets the modem drain the response; returns its airtime (s)
+   and the bytes that went down, which are also appended to 'response' if given (up to SIM_CAPTURE_LEN of them).
+   With a ground framer the link runs framed on both ends by HDLC_Framer */
+double uplink(Radio<I2C_Bus>* radio, uint32_t bps, HDLC_Framer* ground, const std::string& command, size_t* bytes,
+              std::string* response = nullptr) {
+    URTX_Simulator& sim = urtx_simulator();
+
+    std::string packet = {(char)0x1A, (char)0xCF, (char)(command.size() - 1)};
+    packet += command;
+    packet += (char)0x00;
+    if (ground) {
+        std::string framed(ground->maxFramedLen(packet.size()), '\0');
+        framed.resize(ground->frame((const uint8_t*)packet.data(), packet.size(), (uint8_t*)&framed[0]));
+        packet.swap(framed);
+    }
+    sim.injectPacket((const uint8_t*)packet.data(), packet.size());
+    sim.idle((uint64_t)packet.size() * 8 * 1000000000ULL / bps);  // on the air until then
+
+    sim.readDownlink();
+    uint64_t start_ns = sim.now();
+    uint64_t downlinked = sim.getStats().downlinked;
+
+    radio->scan();
+    /* let the modem finish what is queued; the last step overshoots by at most DOWNLINK_STEP_BYTES of airtime
+       (the simulator only keeps the last SIM_CAPTURE_LEN bytes, so the total comes from its counter) */
+    for (size_t drained = 1; drained; ) {
+        sim.idle((uint64_t)DOWNLINK_STEP_BYTES * 8 * 1000000000ULL / bps);
+        std::string chunk = sim.readDownlink();
+        if (response) *response += chunk;
+        if (ground) ground->deframe((const uint8_t*)chunk.data(), chunk.size(), [](const uint8_t*, int) {});
+        drained = chunk.size();
+    }
+    *bytes = sim.getStats().downlinked - downlinked;
+    return (sim.now() - start_ns) / 1e9;
+}
+
+/* requests DOWNLINK_FILE (see uplink) */
+double downlinkFile(Radio<I2C_Bus>* radio, uint32_t bps, HDLC_Framer* ground, size_t* bytes, std::string* response = nullptr) {
+    std::string command = {(char)TELECOM_GET_FILE};
+    command += DOWNLINK_FILE;
+    return uplink(radio, bps, ground, command, bytes, response);
+}
+
+/* requests a file over the simulated uplink and reports how close the downlink came to line rate
+   (uncompressed, so the file's contents do not matter) */
+int downlink(Radio<I2C_Bus>* radio, int kib, uint32_t bps, HDLC_Framer* ground = nullptr) {
+    URTX_Simulator& sim = urtx_simulator();
+    sim.configure({SIM_BUS_100KHZ, bps, bps, false});
+    radio->setCompression(false);
+
+    std::ofstream file(DOWNLINK_FILE, std::ios::binary);
+    for (int i = 0; i < kib * 1024; i++) file.put((char)('a' + i % 26));
+    file.close();
+
+    uint64_t idle_ns = sim.getStats().tx_empty_ns;
+    size_t bytes;
+    double elapsed = downlinkFile(radio, bps, ground, &bytes);
+    remove(DOWNLINK_FILE);
+
+    log_flush();
+    std::cout << std::dec << "Downlink: " << bytes << " bytes in " << elapsed << " s (" << bytes * 8 / elapsed << " bps of " << bps << ")"
+              << ", Modem Idle: " << (sim.getStats().tx_empty_ns - idle_ns) / 1e6 << " ms" << std::endl;
+    radio->printBusStats();
+    if (ground) {
+        radio->getFramer().printStats();
+        std::cout << "Ground ";
+        ground->printStats();
+    }
+    return 0;
+}
+
+/* writes DOWNLINK_FILE as CSV rows like the ones the payloads log: a timestamp, a few slowly changing readings,
+   a status word */
+void writeTelemetry(int kib) {
+    std::ofstream file(DOWNLINK_FILE, std::ios::binary);
+    file << "time,vbat,ibat,temp_obc,temp_pa,rssi,mode,status\n";
+    unsigned seed = 1;
+    for (long row = 0; file.tellp() < (long)kib * 1024; row++) {
+        seed = seed * 1103515245 + 12345;
+        file << 1792224000 + row * 10 << "," << 7400 + (seed >> 16) % 40 << "," << 310 + (seed >> 8) % 25 << ","
+             << 21 + row / 600 % 4 << "," << 34 + (seed >> 20) % 6 << ",-" << 98 + (seed >> 12) % 14 << ","
+             << ((row / 360) % 2 ? "SCIENCE" : "NOMINAL") << ",0x" << std::hex << 0x4100 + (seed >> 24) % 4 << std::dec << "\n";
+    }
+}
+
+/* downlinks a telemetry log twice, as is and compressed, and reports the airtime each took */
+int compress(Radio<I2C_Bus>* radio, int kib, uint32_t bps) {
+    urtx_simulator().configure({SIM_BUS_100KHZ, bps, bps, false});
+
+    writeTelemetry(kib);
+
+    size_t raw_bytes, packed_bytes;
+    radio->setCompression(false);
+    double raw_s = downlinkFile(radio, bps, nullptr, &raw_bytes);
+    radio->setCompression(true);
+    double packed_s = downlinkFile(radio, bps, nullptr, &packed_bytes);
+    remove(DOWNLINK_FILE);
+
+    log_flush();
+    std::cout << std::dec << "Raw: " << raw_bytes << " bytes in " << raw_s << " s, Compressed: " << packed_bytes << " bytes in "
+              << packed_s << " s (" << (packed_s > 0 ? raw_s / packed_s : 0) << "x less airtime)" << std::endl;
+    radio->printBusStats();
+    return 0;
+}
+
+/* requests the same telemetry log repeatedly, as the ground does every pass, then once more after it changed;
+   the frame cache reports how long each request waited for its first packet */
+int cache(Radio<I2C_Bus>* radio, int kib, int requests, uint32_t bps) {
+    urtx_simulator().configure({SIM_BUS_100KHZ, bps, bps, false});
+    writeTelemetry(kib);
+
+    size_t bytes;
+    for (int i = 0; i < requests; i++) {
+        double elapsed = downlinkFile(radio, bps, nullptr, &bytes);
+        std::cout << std::dec << "Request " << i + 1 << ": " << bytes << " bytes in " << elapsed << " s" << std::endl;
+    }
+
+    std::ofstream(DOWNLINK_FILE, std::ios::binary | std::ios::app) << "1792230000,7412,322,22,36,-104,NOMINAL,0x4101\n";
+    double elapsed = downlinkFile(radio, bps, nullptr, &bytes);
+    std::cout << std::dec << "Changed: " << bytes << " bytes in " << elapsed << " s" << std::endl;
+    remove(DOWNLINK_FILE);
+
+    log_flush();
+    radio->printBusStats();
+    return 0;
+}
+
+/* splits captured AX.25-mode packets into their data, by packet number (the first packet's also holds the count) */
+static int parseDownlink(const std::string& capture, std::vector<std::string>* packets, uint8_t* telecom) {
+    int parsed = 0;
+    for (size_t i = 0; i + 4 <= capture.size(); ) {
+        size_t len = (uint8_t)capture[i + 2] + 1;
+        if (i + 3 + len + 1 > capture.size()) break;
+        const uint8_t* field = (const uint8_t*)&capture[i + 3];
+        uint32_t number = (field[1] << 8) | field[2];
+        size_t header = 3;
+        if (number == 1) {
+            packets->resize((field[3] << 8) | field[4]);
+            header = 5;
+        }
+        if (number >= 1 && number <= packets->size()) (*packets)[number - 1].assign((const char*)field + header, len - header);
+        *telecom = field[0];
+        i += 3 + len + 1;
+        parsed++;
+    }
+    return parsed;
+}
+
+/* downlinks a telemetry log while the ground loses a share of the packets, then asks for the missing ones with
+   TELECOM_RETRANSMIT until the log is complete (or ARQ_BENCH_ROUNDS pass), and checks what was reassembled */
+int arq(Radio<I2C_Bus>* radio, int kib, int loss_pct, uint32_t bps) {
+    urtx_simulator().configure({SIM_BUS_100KHZ, bps, bps, false});
+    writeTelemetry(kib);
+    std::ifstream in(DOWNLINK_FILE, std::ios::binary);
+    std::string original((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    unsigned seed = 7;
+    auto lost = [&]() { seed = seed * 1103515245 + 12345; return (int)((seed >> 16) % 100) < loss_pct; };
+
+    size_t bytes;
+    std::string capture;
+    std::vector<std::string> sent, received;
+    uint8_t telecom = 0;
+    double first_s = downlinkFile(radio, bps, nullptr, &bytes, &capture);
+    parseDownlink(capture, &sent, &telecom);
+    received.resize(sent.size());
+    std::vector<bool> have(sent.size());
+    for (size_t n = 0; n < sent.size(); n++) {
+        have[n] = !lost();
+        if (have[n]) received[n] = sent[n];
+    }
+
+    double resent_s = 0;
+    int rounds = 0;
+    for (; rounds < ARQ_BENCH_ROUNDS && std::count(have.begin(), have.end(), false); rounds++) {
+        /* the missing packets as ranges, as many as fit in one uplinked packet at a time */
+        std::vector<std::pair<uint16_t, uint16_t>> ranges;
+        for (size_t n = 0; n < have.size(); n++) {
+            if (have[n]) continue;
+            if (!ranges.empty() && ranges.back().second == n) ranges.back().second = n + 1;
+            else ranges.emplace_back(n + 1, n + 1);
+        }
+        for (size_t r = 0; r < ranges.size(); r += ARQ_BENCH_RANGES) {
+            std::string command = {(char)TELECOM_RETRANSMIT};
+            for (size_t k = r; k < std::min(ranges.size(), r + ARQ_BENCH_RANGES); k++) {
+                command += {(char)(ranges[k].first >> 8), (char)(ranges[k].first & 0xFF), (char)(ranges[k].second >> 8), (char)(ranges[k].second & 0xFF)};
+            }
+            capture.clear();
+            resent_s += uplink(radio, bps, nullptr, command, &bytes, &capture);
+
+            std::vector<std::string> again(sent.size());
+            uint8_t unused;
+            parseDownlink(capture, &again, &unused);
+            for (size_t n = 0; n < again.size(); n++) {
+                if (have[n] || again[n].empty() || lost()) continue;
+                have[n] = true;
+                received[n] = again[n];
+            }
+        }
+    }
+
+    std::string data;
+    for (const std::string& packet : received) data += packet;
+    if (telecom == TELECOM_DOWNLINK_FILE_LZ) {
+        std::string unpacked(original.size(), '\0');
+        int len = LZ_Codec::unpack((const uint8_t*)data.data(), data.size(), (uint8_t*)&unpacked[0], unpacked.size());
+        data = unpacked.substr(0, std::max(len, 0));
+    }
+    remove(DOWNLINK_FILE);
+
+    log_flush();
+    std::cout << std::dec << "Downlink: " << sent.size() << " packets in " << first_s << " s, Lost: " << loss_pct << "%"
+              << ", Retransmission: " << rounds << " rounds in " << resent_s << " s (re-requesting the file: "
+              << first_s << " s a round)" << std::endl;
+    std::cout << "Reassembled: " << (data == original ? "complete" : "INCOMPLETE") << ", " << original.size() << " bytes" << std::endl;
+    radio->printBusStats();
+    return data == original ? 0 : -1;
+}
+#endif
+
+static int64_t us_since(const struct timespec& deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((int64_t)(now.tv_sec - deadline.tv_sec) * 1000000000LL + (now.tv_nsec - deadline.tv_nsec)) / 1000;
+}
+
+/* polls on a fixed period and reports how late each scan woke and finished against its deadline
+   (usage: ./test jitter [scans] [period ms] [rt]) */
+int jitter(Radio<I2C_Bus>* radio, int num_scans, int period_ms, bool rt) {
+#ifdef URTX_SIMULATION
+    urtx_simulator().configure({SIM_BUS_100KHZ, SIM_MODEM_9600BPS, SIM_MODEM_9600BPS, true});
+    for (int i = 1; i <= num_scans / JITTER_COMMAND_EVERY; i++) injectCommand((uint64_t)i * JITTER_COMMAND_EVERY * period_ms * 1000000ULL);
+#endif
+    int rt_status = rt ? radio->enableRealtime() : 0;
+
+    uint32_t histogram[JITTER_BUCKETS] = {0};
+    int64_t wake_max = 0, wake_total = 0, scan_max = 0, scan_total = 0;
+    int overruns = 0;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    for (int i = 0; i < num_scans; i++) {
+        deadline.tv_nsec += period_ms * 1000000L;
+        while (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_nsec -= 1000000000L;
+            deadline.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr);
+        int64_t wake_us = us_since(deadline);
+        radio->poll();
+        int64_t scan_us = us_since(deadline);
+
+        wake_total += wake_us;
+        scan_total += scan_us;
+        wake_max = std::max(wake_max, wake_us);
+        scan_max = std::max(scan_max, scan_us);
+        if (scan_us >= period_ms * 1000) overruns++;
+
+        int bucket = 0;
+        while (bucket < JITTER_BUCKETS - 1 && scan_us >= (1LL << bucket)) bucket++;
+        histogram[bucket]++;
+    }
+
+    log_flush();
+    std::cout << std::dec << "Scans: " << num_scans << ", Period: " << period_ms << " ms, Real-time: "
+              << (!rt ? "off" : (rt_status < 0 ? "partial" : "on")) << std::endl;
+    std::cout << "Wake Latency: avg " << wake_total / num_scans << " us, max " << wake_max << " us" << std::endl;
+    std::cout << "Scan Latency: avg " << scan_total / num_scans << " us, max " << scan_max << " us, Overruns: " << overruns << std::endl;
+    for (int i = 0; i < JITTER_BUCKETS; i++) {
+        if (!histogram[i]) continue;
+        if (i == JITTER_BUCKETS - 1) std::cout << "  >= " << (1 << (i - 1)) << " us: " << histogram[i] << std::endl;
+        else                         std::cout << "  < " << (1 << i) << " us: " << histogram[i] << std::endl;
+    }
+    radio->printBusStats();
+    return 0;
+}
+
+#ifdef URTX_SIMULATION
+/* polls in real time until the stack has settled, then counts the heap allocations (on every thread) made by the
+   idle scans of the next few seconds, the poller's back-off, housekeeping and a health check included; fails
+   unless there are none (usage: ./sim_test malloc [seconds]) */
+int mallocs_per_scan(Radio<I2C_Bus>* radio, int seconds) {
+    urtx_simulator().configure({SIM_BUS_100KHZ, SIM_MODEM_9600BPS, SIM_MODEM_9600BPS, true});
+
+    for (int i = 0; i < MALLOC_WARMUP_SCANS; i++) usleep(radio->poll() * 1000);
+    log_flush();
+
+    radio->getPoller().resetStats();
+    auto end = std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+    mallocs = 0;
+    count_mallocs = true;
+    while (std::chrono::steady_clock::now() < end) {
+        usleep(radio->poll() * 1000);
+    }
+    count_mallocs = false;
+    uint64_t counted = mallocs;
+
+    std::cout << std::dec << "Seconds: " << seconds << ", Allocations: " << counted << std::endl;
+    radio->getPoller().printStats();
+    return counted ? 1 : 0;
+}
+#endif
+
+/* runs a fixed number of scans back-to-back and reports the bus usage (usage: ./test bench [scans]) */
+int bench(Radio<I2C_Bus>* radio, int num_scans) {
+    for (int i = 0; i < num_scans; i++) {
+#ifdef URTX_SIMULATION
+        injectCommand();
+#endif
+        radio->scan();
+    }
+
+    log_flush();
+    std::cout << std::dec << "Scans: " << num_scans << std::endl;
+    radio->printBusStats();
+    return 0;
+}
 
 int main(int argc, char *argv[]) {
 	int config = 0;
-    UHF_Transceiver* transceiver;
-    Radio radio(config);
+    Radio<I2C_Bus> radio(config);
+
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int num_scans = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_SCANS;
+#ifdef URTX_SIMULATION
+        /* usage: ./sim_test bench [scans] [bus hz] [modem bps] */
+        uint32_t bus_hz = (argc > 3) ? atoi(argv[3]) : SIM_BUS_100KHZ;
+        uint32_t bps = (argc > 4) ? atoi(argv[4]) : SIM_MODEM_9600BPS;
+        urtx_simulator().configure({bus_hz, bps, bps, false});
+#endif
+        return bench(&radio, num_scans);
+    }
+    if (argc > 1 && std::string(argv[1]) == "jitter") {
+        int num_scans = (argc > 2) ? atoi(argv[2]) : JITTER_DEFAULT_SCANS;
+        int period_ms = (argc > 3) ? atoi(argv[3]) : JITTER_DEFAULT_PERIOD_MS;
+        bool rt = (argc > 4) && std::string(argv[4]) == "rt";
+        return jitter(&radio, std::max(num_scans, 1), std::max(period_ms, 1), rt);
+    }
+    /* usage: ./test rt (the service loop in real-time mode, see Realtime.h) */
+    if (argc > 1 && std::string(argv[1]) == "rt") {
+        radio.enableRealtime();
+    }
+#ifdef URTX_SIMULATION
+    /* usage: ./sim_test latency [commands] [interval ms] */
+    if (argc > 1 && std::string(argv[1]) == "latency") {
+        int num_commands = (argc > 2) ? atoi(argv[2]) : LATENCY_DEFAULT_COMMANDS;
+        int gap_ms = (argc > 3) ? atoi(argv[3]) : LATENCY_DEFAULT_GAP_MS;
+        return latency(&radio, num_commands, gap_ms);
+    }
+    /* usage: ./sim_test malloc [seconds] */
+    if (argc > 1 && std::string(argv[1]) == "malloc") {
+        int seconds = (argc > 2) ? atoi(argv[2]) : MALLOC_DEFAULT_SECONDS;
+        return mallocs_per_scan(&radio, std::max(seconds, 1));
+    }
+    /* usage: ./sim_test downlink [KiB] [modem bps] */
+    if (argc > 1 && std::string(argv[1]) == "downlink") {
+        int kib = (argc > 2) ? atoi(argv[2]) : DOWNLINK_DEFAULT_KIB;
+        uint32_t bps = (argc > 3) ? atoi(argv[3]) : SIM_MODEM_9600BPS;
+        return downlink(&radio, kib, bps);
+    }
+    /* usage: ./sim_test hdlc [KiB] [modem bps] (transparent mode, framed on the host) */
+    if (argc > 1 && std::string(argv[1]) == "hdlc") {
+        int kib = (argc > 2) ? atoi(argv[2]) : DOWNLINK_DEFAULT_KIB;
+        uint32_t bps = (argc > 3) ? atoi(argv[3]) : SIM_MODEM_9600BPS;
+        HDLC_Framer ground({LINK_SCRAMBLE_VAL, HDLC_DEFAULT_FLAGS});
+        radio.setLinkMode(TRANS_MODE_CONV_DISABLE);
+        return downlink(&radio, kib, bps, &ground);
+    }
+    /* usage: ./sim_test compress [KiB] [modem bps] (a telemetry log, downlinked raw and then compressed) */
+    if (argc > 1 && std::string(argv[1]) == "compress") {
+        int kib = (argc > 2) ? atoi(argv[2]) : DOWNLINK_DEFAULT_KIB;
+        uint32_t bps = (argc > 3) ? atoi(argv[3]) : SIM_MODEM_9600BPS;
+        return compress(&radio, kib, bps);
+    }
+    /* usage: ./sim_test cache [KiB] [requests] [modem bps] (repeated requests for one file) */
+    if (argc > 1 && std::string(argv[1]) == "cache") {
+        int kib = (argc > 2) ? atoi(argv[2]) : DOWNLINK_DEFAULT_KIB;
+        int requests = (argc > 3) ? atoi(argv[3]) : CACHE_DEFAULT_REQUESTS;
+        uint32_t bps = (argc > 4) ? atoi(argv[4]) : SIM_MODEM_9600BPS;
+        return cache(&radio, kib, requests, bps);
+    }
+    /* usage: ./sim_test arq [KiB] [loss %] [modem bps] (lost packets recovered with TELECOM_RETRANSMIT) */
+    if (argc > 1 && std::string(argv[1]) == "arq") {
+        int kib = (argc > 2) ? atoi(argv[2]) : ARQ_DEFAULT_KIB;
+        int loss_pct = (argc > 3) ? atoi(argv[3]) : ARQ_DEFAULT_LOSS;
+        uint32_t bps = (argc > 4) ? atoi(argv[4]) : SIM_MODEM_9600BPS;
+        return arq(&radio, kib, loss_pct, bps);
+    }
+#endif
 
     while(1) {
             // radio.sendString("This is a test!");
-            radio.scan();		// radio.test_scan();
-            sleep(1);
+            usleep(radio.poll() * 1000);		// radio.test_scan();
     }
 
     return 0;
@@ -29,12 +29,15 @@
 #define TELECOM_DEBUG_ON             0xE0
 #define TELECOM_DEBUG_OFF            0x0F
 #define TELECOM_DEBUG_TOGGLE         0x7A
+#define TELECOM_RETRANSMIT           0x5A     // ranges of packets of the last downlink to send again (see Packager::retransmit)
 
 /* Downlinked Commands */
 #define ACKNOWLEDGE                  0x40
 #define TELECOM_LAST_PACKET_RECEIVED 0x11
 #define TELECOM_DOWNLINK_FILE		 0x45
 #define TELECOM_DOWNLINK_STRING      0x46
+#define TELECOM_DOWNLINK_FILE_LZ     0x47     // TELECOM_DOWNLINK_FILE, data packed by LZ_Codec
+#define TELECOM_DOWNLINK_STRING_LZ   0x48     // TELECOM_DOWNLINK_STRING, data packed by LZ_Codec
 
 /* Downlinked Errors */
 #define ERROR                        0x32